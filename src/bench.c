@@ -0,0 +1,252 @@
+#include "sim.h"
+#include "bench.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// --- Configurações dos Benchmarks ---
+// Quantidade de entradas pré-geradas (cabem na cache L2) e de repetições de cada cenário.
+#define BENCH_INPUTS 4096
+#define BENCH_REPETITIONS 2000
+#define BENCH_SEED 12345u
+
+typedef CollisionResult (*PairKernel)(Ball *ball1, Ball *ball2);
+typedef void (*WallKernel)(Ball *ball);
+
+// Variantes de cada kernel. Novas implementações (por exemplo, versões
+// vetorizadas) entram nestas tabelas e passam pelos mesmos cenários.
+typedef struct PairKernelVariant {
+    const char *name;
+    PairKernel kernel;
+} PairKernelVariant;
+
+typedef struct WallKernelVariant {
+    const char *name;
+    WallKernel kernel;
+} WallKernelVariant;
+
+static const PairKernelVariant pairVariants[] = {
+    { "escalar", CheckBallCollision },
+};
+
+static const WallKernelVariant wallVariants[] = {
+    { "escalar", CheckWallCollision },
+};
+
+// Tipos de entrada gerados para cada kernel.
+typedef enum PairCase { PAIR_OVERLAP, PAIR_MISS, PAIR_SEPARATING, PAIR_CASE_COUNT } PairCase;
+typedef enum WallCase { WALL_INSIDE, WALL_HIT, WALL_CASE_COUNT } WallCase;
+
+// Tempos de um cenário, em nanossegundos por chamada.
+typedef struct BenchResult {
+    double meanNs;
+    double minNs;
+} BenchResult;
+
+//==================================================================================
+// Sorteia um float uniforme em [min, max] usando o gerador do raylib.
+//==================================================================================
+static float RandomFloat(float min, float max) {
+    return min + (max - min) * (float)GetRandomValue(0, 1000000) / 1000000.0f;
+}
+
+//==================================================================================
+// Gera um par de bolas do tipo pedido: sobrepostas e se aproximando, sem
+// contato, ou sobrepostas mas já se separando.
+//==================================================================================
+static void GeneratePair(Ball *b1, Ball *b2, PairCase pairCase) {
+    b1->radius = GetRandomValue(MIN_BALL_RADIUS, MAX_BALL_RADIUS);
+    b2->radius = GetRandomValue(MIN_BALL_RADIUS, MAX_BALL_RADIUS);
+    b1->mass = (float)b1->radius / 2.0f;
+    b2->mass = (float)b2->radius / 2.0f;
+    b1->color = b2->color = WHITE;
+
+    float minDist = (float)(b1->radius + b2->radius);
+    float angle = RandomFloat(0.0f, 2.0f * PI);
+    float nx = cosf(angle);
+    float ny = sinf(angle);
+    float distance = (pairCase == PAIR_MISS) ? RandomFloat(1.1f, 5.0f) * minDist : RandomFloat(0.3f, 0.95f) * minDist;
+
+    b1->position = (Vector2){ RandomFloat(100.0f, WIDTH - 100.0f), RandomFloat(100.0f, HEIGHT - 100.0f) };
+    b2->position = (Vector2){ b1->position.x + nx * distance, b1->position.y + ny * distance };
+
+    // A velocidade relativa ao longo da normal define se o impulso é aplicado.
+    float approach = RandomFloat(10.0f, VELOCITY_SCALE);
+    if (pairCase == PAIR_SEPARATING) approach = -approach;
+    b1->velocity = (Vector2){ RandomFloat(-VELOCITY_SCALE, VELOCITY_SCALE), RandomFloat(-VELOCITY_SCALE, VELOCITY_SCALE) };
+    b2->velocity = (Vector2){ b1->velocity.x - approach * nx, b1->velocity.y - approach * ny };
+}
+
+//==================================================================================
+// Gera uma bola longe das paredes ou encostando em uma parede sorteada.
+//==================================================================================
+static void GenerateWallBall(Ball *ball, WallCase wallCase) {
+    ball->radius = GetRandomValue(MIN_BALL_RADIUS, MAX_BALL_RADIUS);
+    ball->mass = (float)ball->radius / 2.0f;
+    ball->color = WHITE;
+    ball->velocity = (Vector2){ RandomFloat(-VELOCITY_SCALE, VELOCITY_SCALE), RandomFloat(-VELOCITY_SCALE, VELOCITY_SCALE) };
+
+    float r = (float)ball->radius;
+    ball->position = (Vector2){ RandomFloat(r + 1.0f, WIDTH - r - 1.0f), RandomFloat(r + 1.0f, HEIGHT - r - 1.0f) };
+    if (wallCase == WALL_HIT) {
+        switch (GetRandomValue(0, 3)) {
+            case 0: ball->position.x = r - RandomFloat(0.0f, 3.0f); break;
+            case 1: ball->position.x = WIDTH - r + RandomFloat(0.0f, 3.0f); break;
+            case 2: ball->position.y = r - RandomFloat(0.0f, 3.0f); break;
+            default: ball->position.y = HEIGHT - r + RandomFloat(0.0f, 3.0f); break;
+        }
+    }
+}
+
+//==================================================================================
+// Embaralha (Fisher-Yates) os índices de uma entrada misturada, para que o
+// resultado de cada desvio seja imprevisível para o preditor.
+//==================================================================================
+static void ShuffleIndices(int indices[], int count) {
+    for (int i = count - 1; i > 0; i--) {
+        int j = GetRandomValue(0, i);
+        int tmp = indices[i];
+        indices[i] = indices[j];
+        indices[j] = tmp;
+    }
+}
+
+//==================================================================================
+// Mede um kernel de pares. A cópia de trabalho é restaurada fora da região
+// cronometrada, já que o kernel altera posições e velocidades. Se 'order'
+// for dado, a cada repetição os pares são reembaralhados, impedindo que o
+// preditor de desvios decore a sequência.
+//==================================================================================
+static BenchResult TimePairKernel(PairKernel kernel, const Ball pristine[], Ball work[], int numPairs, int order[]) {
+    BenchResult result = { 0.0, 1e30 };
+    uint64_t total = 0;
+
+    for (int rep = 0; rep < BENCH_REPETITIONS; rep++) {
+        if (order) {
+            ShuffleIndices(order, numPairs);
+            for (int i = 0; i < numPairs; i++) {
+                work[2 * i] = pristine[2 * order[i]];
+                work[2 * i + 1] = pristine[2 * order[i] + 1];
+            }
+        } else {
+            memcpy(work, pristine, sizeof(Ball) * 2 * numPairs);
+        }
+        uint64_t start = TimerNowNs();
+        for (int i = 0; i < numPairs; i++) {
+            kernel(&work[2 * i], &work[2 * i + 1]);
+        }
+        uint64_t elapsed = TimerNowNs() - start;
+        total += elapsed;
+        if ((double)elapsed < result.minNs) result.minNs = (double)elapsed;
+    }
+
+    result.meanNs = (double)total / BENCH_REPETITIONS / numPairs;
+    result.minNs /= numPairs;
+    return result;
+}
+
+//==================================================================================
+// Mede um kernel de parede, com a mesma restauração (e reembaralhamento
+// opcional) fora do tempo medido.
+//==================================================================================
+static BenchResult TimeWallKernel(WallKernel kernel, const Ball pristine[], Ball work[], int numBalls, int order[]) {
+    BenchResult result = { 0.0, 1e30 };
+    uint64_t total = 0;
+
+    for (int rep = 0; rep < BENCH_REPETITIONS; rep++) {
+        if (order) {
+            ShuffleIndices(order, numBalls);
+            for (int i = 0; i < numBalls; i++) work[i] = pristine[order[i]];
+        } else {
+            memcpy(work, pristine, sizeof(Ball) * numBalls);
+        }
+        uint64_t start = TimerNowNs();
+        for (int i = 0; i < numBalls; i++) {
+            kernel(&work[i]);
+        }
+        uint64_t elapsed = TimerNowNs() - start;
+        total += elapsed;
+        if ((double)elapsed < result.minNs) result.minNs = (double)elapsed;
+    }
+
+    result.meanNs = (double)total / BENCH_REPETITIONS / numBalls;
+    result.minNs /= numBalls;
+    return result;
+}
+
+static void PrintResult(const char *kernel, const char *variant, const char *scenario, BenchResult result) {
+    printf("%-20s %-10s %-24s %10.2f %10.2f\n", kernel, variant, scenario, result.meanNs, result.minNs);
+}
+
+//==================================================================================
+// Gera as entradas em memória e roda todos os cenários para cada variante.
+// Além dos cenários puros, mede a mesma mistura de casos em ordem agrupada
+// (desvios previsíveis) e embaralhada (desvios imprevisíveis): a diferença
+// entre as duas estima o custo de branch miss do kernel.
+//==================================================================================
+int RunKernelBenchmarks(void) {
+    static const char *pairCaseNames[PAIR_CASE_COUNT] = { "sobreposicao", "sem contato", "separando" };
+    static const char *wallCaseNames[WALL_CASE_COUNT] = { "interior", "parede" };
+
+    Ball *pristine = (Ball *)malloc(sizeof(Ball) * 2 * BENCH_INPUTS);
+    Ball *sorted = (Ball *)malloc(sizeof(Ball) * 2 * BENCH_INPUTS);
+    Ball *work = (Ball *)malloc(sizeof(Ball) * 2 * BENCH_INPUTS);
+    int *indices = (int *)malloc(sizeof(int) * BENCH_INPUTS);
+    if (!pristine || !sorted || !work || !indices) {
+        fprintf(stderr, "Memória insuficiente para os benchmarks\n");
+        free(pristine); free(sorted); free(work); free(indices);
+        return 1;
+    }
+
+    SetRandomSeed(BENCH_SEED);
+    printf("%d entradas por cenário, %d repetições\n\n", BENCH_INPUTS, BENCH_REPETITIONS);
+    printf("%-20s %-10s %-24s %10s %10s\n", "kernel", "variante", "cenário", "ns (média)", "ns (mín)");
+
+    // --- CheckBallCollision ---
+    // Mistura: terços iguais de cada caso, agrupados por tipo; a versão
+    // embaralhada usa exatamente os mesmos pares em ordem aleatória.
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        GeneratePair(&sorted[2 * i], &sorted[2 * i + 1], (PairCase)(i * PAIR_CASE_COUNT / BENCH_INPUTS));
+        indices[i] = i;
+    }
+
+    for (size_t v = 0; v < sizeof(pairVariants) / sizeof(pairVariants[0]); v++) {
+        for (int c = 0; c < PAIR_CASE_COUNT; c++) {
+            for (int i = 0; i < BENCH_INPUTS; i++) GeneratePair(&pristine[2 * i], &pristine[2 * i + 1], (PairCase)c);
+            PrintResult("CheckBallCollision", pairVariants[v].name, pairCaseNames[c],
+                        TimePairKernel(pairVariants[v].kernel, pristine, work, BENCH_INPUTS, NULL));
+        }
+        BenchResult grouped = TimePairKernel(pairVariants[v].kernel, sorted, work, BENCH_INPUTS, NULL);
+        BenchResult mixed = TimePairKernel(pairVariants[v].kernel, sorted, work, BENCH_INPUTS, indices);
+        PrintResult("CheckBallCollision", pairVariants[v].name, "mistura agrupada", grouped);
+        PrintResult("CheckBallCollision", pairVariants[v].name, "mistura embaralhada", mixed);
+        printf("%-20s %-10s %-24s %10.2f\n", "CheckBallCollision", pairVariants[v].name, "custo de branch miss", mixed.minNs - grouped.minNs);
+    }
+
+    // --- CheckWallCollision ---
+    for (int i = 0; i < BENCH_INPUTS; i++) {
+        GenerateWallBall(&sorted[i], (WallCase)(i * WALL_CASE_COUNT / BENCH_INPUTS));
+        indices[i] = i;
+    }
+
+    for (size_t v = 0; v < sizeof(wallVariants) / sizeof(wallVariants[0]); v++) {
+        for (int c = 0; c < WALL_CASE_COUNT; c++) {
+            for (int i = 0; i < BENCH_INPUTS; i++) GenerateWallBall(&pristine[i], (WallCase)c);
+            PrintResult("CheckWallCollision", wallVariants[v].name, wallCaseNames[c],
+                        TimeWallKernel(wallVariants[v].kernel, pristine, work, BENCH_INPUTS, NULL));
+        }
+        BenchResult grouped = TimeWallKernel(wallVariants[v].kernel, sorted, work, BENCH_INPUTS, NULL);
+        BenchResult mixed = TimeWallKernel(wallVariants[v].kernel, sorted, work, BENCH_INPUTS, indices);
+        PrintResult("CheckWallCollision", wallVariants[v].name, "mistura agrupada", grouped);
+        PrintResult("CheckWallCollision", wallVariants[v].name, "mistura embaralhada", mixed);
+        printf("%-20s %-10s %-24s %10.2f\n", "CheckWallCollision", wallVariants[v].name, "custo de branch miss", mixed.minNs - grouped.minNs);
+    }
+
+    free(pristine);
+    free(sorted);
+    free(work);
+    free(indices);
+    return 0;
+}
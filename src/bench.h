@@ -0,0 +1,9 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+// Executa os microbenchmarks isolados de CheckBallCollision e
+// CheckWallCollision e imprime ns/chamada de cada cenário. Retorna o código
+// de saída do processo.
+int RunKernelBenchmarks(void);
+
+#endif
@@ -0,0 +1,98 @@
+#include "grid.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+int SpatialGridColumn(const SpatialGrid *grid, float x) {
+    int col = (int)(x / grid->cellSize);
+    if (col < 0) return 0;
+    if (col >= grid->cols) return grid->cols - 1;
+    return col;
+}
+
+int SpatialGridRow(const SpatialGrid *grid, float y) {
+    int row = (int)(y / grid->cellSize);
+    if (row < 0) return 0;
+    if (row >= grid->rows) return grid->rows - 1;
+    return row;
+}
+
+//==================================================================================
+// (Re)constrói a grade para o estado atual das bolas. Os buffers são
+// reaproveitados entre passos e só crescem quando necessário.
+// Retorna false se faltar memória.
+//==================================================================================
+bool BuildSpatialGrid(SpatialGrid *grid, const Ball balls[], int numBalls, float cellSize) {
+    grid->cellSize = cellSize;
+    grid->cols = (int)ceilf(WIDTH / cellSize);
+    grid->rows = (int)ceilf(HEIGHT / cellSize);
+    if (grid->cols < 1) grid->cols = 1;
+    if (grid->rows < 1) grid->rows = 1;
+    grid->reach = (int)ceilf(2.0f * MAX_BALL_RADIUS / cellSize);
+
+    int numCells = grid->cols * grid->rows;
+    if (numCells + 1 > grid->cellCapacity) {
+        int *cellStart = (int *)realloc(grid->cellStart, sizeof(int) * (numCells + 1));
+        if (cellStart == NULL) return false;
+        grid->cellStart = cellStart;
+        grid->cellCapacity = numCells + 1;
+    }
+    if (numBalls > grid->ballCapacity) {
+        int *cellBalls = (int *)realloc(grid->cellBalls, sizeof(int) * numBalls);
+        if (cellBalls == NULL) return false;
+        grid->cellBalls = cellBalls;
+        int *ballCell = (int *)realloc(grid->ballCell, sizeof(int) * numBalls);
+        if (ballCell == NULL) return false;
+        grid->ballCell = ballCell;
+        grid->ballCapacity = numBalls;
+    }
+
+    // Counting sort: conta por célula, soma prefixada, depois distribui.
+    memset(grid->cellStart, 0, sizeof(int) * (numCells + 1));
+    for (int i = 0; i < numBalls; i++) {
+        int cell = SpatialGridRow(grid, balls[i].position.y) * grid->cols + SpatialGridColumn(grid, balls[i].position.x);
+        grid->ballCell[i] = cell;
+        grid->cellStart[cell + 1]++;
+    }
+    for (int c = 0; c < numCells; c++) grid->cellStart[c + 1] += grid->cellStart[c];
+    for (int i = 0; i < numBalls; i++) {
+        // Usa cellStart[cell] como cursor de escrita e o restaura logo abaixo.
+        grid->cellBalls[grid->cellStart[grid->ballCell[i]]++] = i;
+    }
+    for (int c = numCells; c > 0; c--) grid->cellStart[c] = grid->cellStart[c - 1];
+    grid->cellStart[0] = 0;
+    return true;
+}
+
+int QuerySpatialGrid(const SpatialGrid *grid, float minX, float minY, float maxX, float maxY, int **indices, int *capacity) {
+    int colMin = SpatialGridColumn(grid, minX);
+    int colMax = SpatialGridColumn(grid, maxX);
+    int rowMin = SpatialGridRow(grid, minY);
+    int rowMax = SpatialGridRow(grid, maxY);
+
+    // As bolas de uma linha de células são contíguas em cellBalls entre
+    // colMin e colMax, então cada linha é uma cópia só.
+    int count = 0;
+    for (int r = rowMin; r <= rowMax; r++) {
+        int first = grid->cellStart[r * grid->cols + colMin];
+        int last = grid->cellStart[r * grid->cols + colMax + 1];
+        if (count + (last - first) > *capacity) {
+            int newCapacity = (*capacity > 0) ? *capacity : 1024;
+            while (newCapacity < count + (last - first)) newCapacity *= 2;
+            int *grown = (int *)realloc(*indices, sizeof(int) * newCapacity);
+            if (grown == NULL) return -1;
+            *indices = grown;
+            *capacity = newCapacity;
+        }
+        memcpy(*indices + count, grid->cellBalls + first, sizeof(int) * (last - first));
+        count += last - first;
+    }
+    return count;
+}
+
+void FreeSpatialGrid(SpatialGrid *grid) {
+    free(grid->cellStart);
+    free(grid->cellBalls);
+    free(grid->ballCell);
+    memset(grid, 0, sizeof(*grid));
+}
@@ -0,0 +1,33 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include "sim.h"
+
+// --- Grade espacial uniforme ---
+// Índices das bolas ordenados por célula (counting sort), reconstruída a
+// cada passo. Serve de broadphase: só bolas em células vizinhas viram pares
+// candidatos.
+typedef struct SpatialGrid {
+    float cellSize;
+    int cols;
+    int rows;
+    int reach;           // Células vizinhas a visitar em cada direção para cobrir o maior diâmetro.
+    int *cellStart;      // cols*rows + 1 entradas; bolas da célula c em cellBalls[cellStart[c] .. cellStart[c+1]).
+    int *cellBalls;      // Índices das bolas ordenados por célula.
+    int *ballCell;       // Célula de cada bola no momento da construção.
+    int cellCapacity;
+    int ballCapacity;
+} SpatialGrid;
+
+bool BuildSpatialGrid(SpatialGrid *grid, const Ball balls[], int numBalls, float cellSize);
+void FreeSpatialGrid(SpatialGrid *grid);
+
+// Célula (coluna/linha) de um ponto do mundo, limitada às bordas da grade.
+int SpatialGridColumn(const SpatialGrid *grid, float x);
+int SpatialGridRow(const SpatialGrid *grid, float y);
+
+// Junta em 'indices' (realocado se preciso) as bolas das células que tocam o
+// retângulo [minX, maxX] x [minY, maxY]. Retorna quantas, ou -1 sem memória.
+int QuerySpatialGrid(const SpatialGrid *grid, float minX, float minY, float maxX, float maxY, int **indices, int *capacity);
+
+#endif
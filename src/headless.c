@@ -0,0 +1,237 @@
+#include "headless.h"
+#include "profiler.h"
+#include "perfcounters.h"
+#include "trace.h"
+#include "timer.h"
+#include "statehash.h"
+#include "trajectory.h"
+#include "softraster.h"
+#include "observables.h"
+#include "mapped_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//==================================================================================
+// Escreve o cabeçalho do CSV: uma coluna de tempo por fase e, com os
+// contadores de hardware ativos, uma coluna por fase e contador (vazia nas
+// linhas se o processador não oferecer o contador).
+//==================================================================================
+static void WriteCsvHeader(FILE *csv) {
+    fprintf(csv, "passo,bolas,energia,temperatura,momento_x,momento_y,pressao,ms_por_passo,candidatos,contatos,impulsos");
+    for (int p = 0; p < PHASE_COUNT; p++) fprintf(csv, ",%s_ms", ProfilerPhaseKey((ProfilerPhase)p));
+    if (PerfCountersEnabled()) {
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+                fprintf(csv, ",%s_%s", ProfilerPhaseKey((ProfilerPhase)p), PerfCounterName((PerfCounter)c));
+            }
+        }
+    }
+    fprintf(csv, "\n");
+}
+
+//==================================================================================
+// Escreve uma linha com as médias por passo desde a linha anterior; a pressão
+// é a média no tempo simulado desde ela. 'previousNs', 'previousPairs' e
+// 'previousCounters' guardam os totais da linha anterior.
+//==================================================================================
+static void WriteCsvRow(FILE *csv, long long step, int numBalls, float energy, int windowSteps, uint64_t windowNs,
+                        uint64_t previousNs[PHASE_COUNT], CollisionCounters *previousPairs,
+                        uint64_t previousCounters[PHASE_COUNT][PERF_COUNTER_COUNT]) {
+    Thermodynamics thermo = SampleThermodynamics(numBalls, 0.0);
+    fprintf(csv, "%lld,%d,%.3f,%.6g,%.6g,%.6g,%.6g,%.6f", step, numBalls, energy, thermo.temperature, thermo.momentumX,
+            thermo.momentumY, thermo.pressure, windowNs / 1e6 / windowSteps);
+    fprintf(csv, ",%.1f,%.1f,%.1f", (double)(totalCounters.candidatePairs - previousPairs->candidatePairs) / windowSteps,
+            (double)(totalCounters.overlappingPairs - previousPairs->overlappingPairs) / windowSteps,
+            (double)(totalCounters.impulsePairs - previousPairs->impulsePairs) / windowSteps);
+    *previousPairs = totalCounters;
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        uint64_t total = ProfilerTotalNs((ProfilerPhase)p);
+        fprintf(csv, ",%.6f", (total - previousNs[p]) / 1e6 / windowSteps);
+        previousNs[p] = total;
+    }
+    if (PerfCountersEnabled()) {
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+                if (!PerfCounterAvailable((PerfCounter)c)) {
+                    fprintf(csv, ",");
+                    continue;
+                }
+                uint64_t total = ProfilerCounterTotal((ProfilerPhase)p, (PerfCounter)c);
+                fprintf(csv, ",%.1f", (double)(total - previousCounters[p][c]) / windowSteps);
+                previousCounters[p][c] = total;
+            }
+        }
+    }
+    fprintf(csv, "\n");
+}
+
+//==================================================================================
+// Grava o checkpoint num arquivo temporário e só então o renomeia sobre o
+// anterior. O CSV é esvaziado antes, para que as linhas até este passo já
+// estejam no disco, e seu tamanho vai junto no checkpoint.
+//==================================================================================
+static bool WriteCheckpoint(const char *path, const Ball balls[], int numBalls, SnapshotRun *run, FILE *csv) {
+    if (csv != NULL) {
+        fflush(csv);
+        long bytes = ftell(csv);
+        run->csvBytes = (bytes > 0) ? bytes : 0;
+    }
+
+    size_t length = strlen(path);
+    char *temporary = (char *)malloc(length + 5);
+    if (temporary == NULL) return false;
+    memcpy(temporary, path, length);
+    memcpy(temporary + length, ".tmp", 5);
+
+    bool ok = SaveSnapshot(temporary, balls, numBalls, run) && ReplaceFileAtomically(temporary, path);
+    if (!ok) {
+        fprintf(stderr, "Falha ao gravar o checkpoint %s no passo %lld\n", path, simStep);
+        remove(temporary);
+    }
+    free(temporary);
+    return ok;
+}
+
+//==================================================================================
+// Loop sem janela: as mesmas fases do loop principal, com passo fixo.
+//==================================================================================
+int RunHeadless(Ball balls[], int numBalls, const HeadlessOptions *options) {
+    uint64_t previousNs[PHASE_COUNT] = { 0 };
+    uint64_t previousCounters[PHASE_COUNT][PERF_COUNTER_COUNT] = { { 0 } };
+    CollisionCounters previousPairs = totalCounters;
+    int reportEvery = (options->reportEvery > 0) ? options->reportEvery : 100;
+    float totalKE = (float)systemTotals.kineticEnergy;
+
+    // Passos contados a partir do início da execução, que num --resume é o
+    // da execução original.
+    SnapshotRun run = { simStep, simStep + options->steps, NULL, 0, 0, reportEvery, energyCheckEvery };
+    if (options->resume != NULL) {
+        run.startStep = options->resume->startStep;
+        run.endStep = options->resume->endStep;
+    }
+    long long firstStep = simStep;
+    int energyCapacity = 0;
+    if (options->resume != NULL && options->resume->energyCount > 0) {
+        energyCapacity = options->resume->energyCount;
+        run.energyHistory = (float *)malloc(sizeof(float) * energyCapacity);
+        if (run.energyHistory == NULL) return 1;
+        memcpy(run.energyHistory, options->resume->energyHistory, sizeof(float) * energyCapacity);
+        run.energyCount = energyCapacity;
+    }
+
+    // Num --resume, as linhas gravadas depois do checkpoint seriam repetidas
+    // pelos passos refeitos; o CSV volta ao tamanho que tinha nele.
+    FILE *csv = NULL;
+    if (options->csvPath != NULL) {
+        if (options->resume != NULL && options->resume->csvBytes > 0 &&
+            !TruncateFile(options->csvPath, (uint64_t)options->resume->csvBytes)) {
+            fprintf(stderr, "%s não corresponde ao checkpoint; as linhas novas vão para o fim do arquivo\n",
+                    options->csvPath);
+        }
+        csv = fopen(options->csvPath, (options->resume != NULL) ? "a" : "w");
+        if (csv == NULL) {
+            fprintf(stderr, "Não foi possível criar %s\n", options->csvPath);
+            free(run.energyHistory);
+            return 1;
+        }
+        fseek(csv, 0, SEEK_END);
+        if (ftell(csv) == 0) WriteCsvHeader(csv);
+    }
+
+    uint64_t runStart = TimerNowNs();
+    uint64_t windowStart = runStart;
+    int windowSteps = 0;
+    int result = 0;
+
+    while (simStep < run.endStep) {
+        StepSimulation(balls, numBalls, fixedDeltaTime);
+        long long step = simStep - run.startStep;
+
+        totalKE = (float)systemTotals.kineticEnergy;
+
+        if (FrameExportActive()) {
+            PROFILE_BEGIN(PHASE_DRAW);
+            bool exported = FrameExportStep(balls, numBalls, simStep);
+            PROFILE_END(PHASE_DRAW);
+            if (!exported) {
+                result = 1;
+                break;
+            }
+        }
+
+        PROFILE_FRAME();
+        TraceFrame();
+        windowSteps++;
+
+        if (step % reportEvery == 0) {
+            if (run.energyCount == energyCapacity) {
+                int capacity = (energyCapacity > 0) ? 2 * energyCapacity : 256;
+                float *history = (float *)realloc(run.energyHistory, sizeof(float) * capacity);
+                if (history != NULL) {
+                    run.energyHistory = history;
+                    energyCapacity = capacity;
+                }
+            }
+            if (run.energyCount < energyCapacity) run.energyHistory[run.energyCount++] = totalKE;
+        }
+        if (csv != NULL && (step % reportEvery == 0 || simStep == run.endStep)) {
+            uint64_t now = TimerNowNs();
+            WriteCsvRow(csv, step, numBalls, totalKE, windowSteps, now - windowStart, previousNs, &previousPairs, previousCounters);
+            windowStart = now;
+            windowSteps = 0;
+        }
+        if (options->checkpointPath != NULL && options->checkpointEvery > 0 && step % options->checkpointEvery == 0 &&
+            !WriteCheckpoint(options->checkpointPath, balls, numBalls, &run, csv)) {
+            result = 1;
+            break;
+        }
+    }
+
+    double seconds = (TimerNowNs() - runStart) / 1e9;
+    if (csv != NULL) fclose(csv);
+
+    // Tempos medidos só neste processo; contadores acumulados desde o início da execução.
+    long long steps = simStep - firstStep;
+    long long countedSteps = simStep - run.startStep;
+    printf("%lld passos com %d bolas em %.3f s (%.1f passos/s), semente %u, dt %g s\n", steps, numBalls, seconds,
+           (seconds > 0.0) ? steps / seconds : 0.0, simSeed, fixedDeltaTime);
+    if (options->resume != NULL) printf("Retomada no passo %lld de %lld\n", firstStep, run.endStep);
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        printf("  %-12s %10.4f ms/passo\n", ProfilerPhaseName((ProfilerPhase)p),
+               (steps > 0) ? ProfilerTotalNs((ProfilerPhase)p) / 1e6 / steps : 0.0);
+    }
+    if (countedSteps > 0) {
+        long long candidates = totalCounters.candidatePairs;
+        printf("Pares por passo: %.1f candidatos, %.1f contatos (%.3f%%), %.1f impulsos\n",
+               (double)candidates / countedSteps, (double)totalCounters.overlappingPairs / countedSteps,
+               candidates ? 100.0 * totalCounters.overlappingPairs / candidates : 0.0,
+               (double)totalCounters.impulsePairs / countedSteps);
+    }
+    if (run.energyCount >= 2 && run.energyHistory[0] != 0.0f) {
+        printf("Histórico de energia: %d amostras, deriva de %.4f%% entre a primeira e a última\n", run.energyCount,
+               100.0 * (run.energyHistory[run.energyCount - 1] - run.energyHistory[0]) / run.energyHistory[0]);
+    }
+    free(run.energyHistory);
+    EnergyDrift drift = GetEnergyDrift();
+    Thermodynamics thermo = RunThermodynamics(numBalls);
+    printf("Energia cinética final: %.0f\n", totalKE);
+    printf("Temperatura %.6g, momento (%.4g, %.4g), pressão média nas paredes %.6g (PA/NT = %.4f)\n", thermo.temperature,
+           thermo.momentumX, thermo.momentumY, thermo.pressure, thermo.compressibility);
+    if (drift.steps > 0) {
+        printf("Deriva de energia: %+.3e em %lld passos (%+.3e por 10^6 passos); totais mantidos diferem %.1e da soma completa\n",
+               drift.relativeDrift, drift.steps, drift.perMillionSteps, drift.trackedError);
+    }
+    printf("Hash final do estado: %016llx\n", (unsigned long long)HashBallState(balls, numBalls));
+    if (TrajectoryActive()) {
+        TrajectoryStats stats = TrajectoryGetStats();
+        printf("Trajetória: %lld quadros na fila, %lld esperas por buffer livre (%.1f ms)\n",
+               stats.framesQueued, stats.stalls, stats.stallMs);
+    }
+    if (FrameExportActive()) {
+        FrameExportStats frames = FrameExportGetStats();
+        printf("Quadros: %lld gravados, %.2f ms desenhando e %.2f ms gravando por quadro\n", frames.frames,
+               frames.frames ? frames.rasterMs / frames.frames : 0.0, frames.frames ? frames.writeMs / frames.frames : 0.0);
+    }
+    return result;
+}
@@ -0,0 +1,31 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include "sim.h"
+#include "snapshot.h"
+
+// Passo fixo usado quando não há janela para fornecer GetFrameTime e
+// nenhum --dt foi dado (equivale ao FPS alvo da janela).
+#define HEADLESS_DELTA_TIME (1.0f / 144.0f)
+
+// Parâmetros de uma execução sem janela.
+typedef struct HeadlessOptions {
+    int steps;               // Número de passos a simular.
+    int reportEvery;         // Passos por linha do CSV (e por amostra do histórico de energia).
+    const char *csvPath;     // Arquivo CSV do benchmark (NULL para não gravar).
+    const char *checkpointPath;   // Checkpoint periódico (NULL para não gravar).
+    int checkpointEvery;          // Passos entre checkpoints.
+    const SnapshotRun *resume;    // Execução a continuar (--resume), ou NULL.
+} HeadlessOptions;
+
+// Simula sem abrir janela, gravando os tempos por fase (e os contadores de
+// hardware, se ativos) no CSV. A cada checkpointEvery passos grava um
+// checkpoint num arquivo temporário e o renomeia sobre o anterior, então um
+// processo interrompido sempre deixa um checkpoint completo. Com 'resume', a
+// execução continua do checkpoint até o passo final original, acrescentando
+// ao mesmo CSV (cortado de volta ao tamanho que tinha no checkpoint). Com
+// FrameExportStart ativo (ver softraster.h), também grava quadros desenhados
+// na CPU, contados na fase de desenho. Retorna o código de saída do processo.
+int RunHeadless(Ball balls[], int numBalls, const HeadlessOptions *options);
+
+#endif
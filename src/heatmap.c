@@ -0,0 +1,170 @@
+#include "heatmap.h"
+#include "threadpool.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Bolas por thread abaixo das quais não compensa dividir o histograma.
+#define HEATMAP_MIN_BALLS_PER_WORKER 16384
+
+static struct {
+    int columns;
+    int rows;
+    float *partial;          // Um histograma por thread, um após o outro.
+    int partialWorkers;
+    float *total;
+    unsigned char *pixels;   // RGBA8.
+    Texture2D texture;
+    Color palette[256];
+    bool paletteReady;
+} heatmap = { 0 };
+
+typedef struct BinContext {
+    const Ball *balls;
+    float cellsPerUnitX;
+    float cellsPerUnitY;
+} BinContext;
+
+const char *HeatmapQuantityName(HeatmapQuantity quantity) {
+    return (quantity == HEATMAP_ENERGY) ? "energia" : "densidade";
+}
+
+//==================================================================================
+// Mapa de cores do preto ao amarelo-claro passando por roxo, vermelho e
+// laranja (parecido com o "inferno" do matplotlib), interpolado entre cinco
+// cores de controle.
+//==================================================================================
+static void BuildPalette(void) {
+    static const float stops[5][3] = {
+        { 0, 0, 4 }, { 87, 16, 110 }, { 188, 55, 84 }, { 249, 142, 9 }, { 252, 255, 164 }
+    };
+    for (int i = 0; i < 256; i++) {
+        float t = i / 255.0f * 4.0f;
+        int k = (t >= 4.0f) ? 3 : (int)t;
+        float f = t - k;
+        heatmap.palette[i] = (Color){
+            (unsigned char)(stops[k][0] + (stops[k + 1][0] - stops[k][0]) * f),
+            (unsigned char)(stops[k][1] + (stops[k + 1][1] - stops[k][1]) * f),
+            (unsigned char)(stops[k][2] + (stops[k + 1][2] - stops[k][2]) * f),
+            255
+        };
+    }
+    heatmap.paletteReady = true;
+}
+
+//==================================================================================
+// Prepara os buffers e a textura para a resolução atual. A textura é recriada
+// só quando o mundo muda de proporção.
+//==================================================================================
+static bool EnsureBuffers(void) {
+    int columns = HEATMAP_COLUMNS;
+    int rows = (int)ceilf((float)HEATMAP_COLUMNS * HEIGHT / WIDTH);
+    if (rows < 1) rows = 1;
+    if (rows > 4 * HEATMAP_COLUMNS) rows = 4 * HEATMAP_COLUMNS;
+    int workers = ThreadPoolWorkers();
+    if (columns == heatmap.columns && rows == heatmap.rows && workers == heatmap.partialWorkers && heatmap.texture.id != 0) {
+        return true;
+    }
+
+    HeatmapShutdown();
+    size_t cells = (size_t)columns * rows;
+    heatmap.partial = (float *)malloc(sizeof(float) * cells * workers);
+    heatmap.total = (float *)malloc(sizeof(float) * cells);
+    heatmap.pixels = (unsigned char *)calloc(cells, 4);
+    if (heatmap.partial == NULL || heatmap.total == NULL || heatmap.pixels == NULL) {
+        HeatmapShutdown();
+        return false;
+    }
+    Image image = { heatmap.pixels, columns, rows, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+    heatmap.texture = LoadTextureFromImage(image);
+    if (heatmap.texture.id == 0) {
+        HeatmapShutdown();
+        return false;
+    }
+    SetTextureFilter(heatmap.texture, TEXTURE_FILTER_BILINEAR);
+    heatmap.columns = columns;
+    heatmap.rows = rows;
+    heatmap.partialWorkers = workers;
+    return true;
+}
+
+static void BinBalls(void *context, int begin, int end, int worker) {
+    const BinContext *bin = (const BinContext *)context;
+    size_t cells = (size_t)heatmap.columns * heatmap.rows;
+    float *histogram = heatmap.partial + cells * worker;
+    memset(histogram, 0, sizeof(float) * cells);
+
+    for (int i = begin; i < end; i++) {
+        const Ball *ball = &bin->balls[i];
+        int col = (int)(ball->position.x * bin->cellsPerUnitX);
+        int row = (int)(ball->position.y * bin->cellsPerUnitY);
+        if (col < 0) col = 0;
+        if (col >= heatmap.columns) col = heatmap.columns - 1;
+        if (row < 0) row = 0;
+        if (row >= heatmap.rows) row = heatmap.rows - 1;
+        float value = 1.0f;
+        if (heatmapQuantity == HEATMAP_ENERGY) {
+            value = 0.5f * ball->mass * (ball->velocity.x * ball->velocity.x + ball->velocity.y * ball->velocity.y);
+        }
+        histogram[row * heatmap.columns + col] += value;
+    }
+}
+
+// Soma os histogramas das threads que participaram, por faixa de células.
+static void ReduceHistograms(void *context, int begin, int end, int worker) {
+    (void)worker;
+    int used = *(const int *)context;
+    size_t cells = (size_t)heatmap.columns * heatmap.rows;
+    for (int c = begin; c < end; c++) {
+        float sum = 0.0f;
+        for (int w = 0; w < used; w++) sum += heatmap.partial[cells * w + c];
+        heatmap.total[c] = sum;
+    }
+}
+
+//==================================================================================
+// Histograma em paralelo, redução, cores em escala logarítmica (log(1 + v)
+// normalizado pelo maior valor) e um único UpdateTexture.
+//==================================================================================
+void DrawHeatmap(const Ball balls[], int numBalls) {
+    if (!heatmap.paletteReady) BuildPalette();
+    if (!EnsureBuffers()) return;
+
+    BinContext bin = { balls, heatmap.columns / (float)WIDTH, heatmap.rows / (float)HEIGHT };
+    int used = numBalls / HEATMAP_MIN_BALLS_PER_WORKER;
+    if (used > heatmap.partialWorkers) used = heatmap.partialWorkers;
+    if (used < 1) used = 1;
+    // Cada thread de BinBalls zera o próprio histograma; as que não
+    // participam ficam fora da redução.
+    ParallelFor(numBalls, HEATMAP_MIN_BALLS_PER_WORKER, BinBalls, &bin);
+    if (numBalls == 0) memset(heatmap.partial, 0, sizeof(float) * heatmap.columns * heatmap.rows);
+    int cells = heatmap.columns * heatmap.rows;
+    ParallelFor(cells, 4096, ReduceHistograms, &used);
+
+    float maximum = 0.0f;
+    for (int c = 0; c < cells; c++) {
+        if (heatmap.total[c] > maximum) maximum = heatmap.total[c];
+    }
+    float scale = (maximum > 0.0f) ? 255.0f / logf(1.0f + maximum) : 0.0f;
+    for (int c = 0; c < cells; c++) {
+        int index = (int)(logf(1.0f + heatmap.total[c]) * scale);
+        memcpy(heatmap.pixels + 4 * c, &heatmap.palette[index > 255 ? 255 : index], 4);
+    }
+    UpdateTexture(heatmap.texture, heatmap.pixels);
+
+    Rectangle source = { 0.0f, 0.0f, (float)heatmap.columns, (float)heatmap.rows };
+    Rectangle dest = { 0.0f, 0.0f, (float)WIDTH, (float)HEIGHT };
+    DrawTexturePro(heatmap.texture, source, dest, (Vector2){ 0.0f, 0.0f }, 0.0f, WHITE);
+}
+
+void HeatmapShutdown(void) {
+    if (heatmap.texture.id != 0) UnloadTexture(heatmap.texture);
+    free(heatmap.partial);
+    free(heatmap.total);
+    free(heatmap.pixels);
+    heatmap.partial = NULL;
+    heatmap.total = NULL;
+    heatmap.pixels = NULL;
+    heatmap.texture = (Texture2D){ 0 };
+    heatmap.columns = heatmap.rows = heatmap.partialWorkers = 0;
+}
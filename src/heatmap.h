@@ -0,0 +1,28 @@
+#ifndef HEATMAP_H
+#define HEATMAP_H
+
+#include "sim.h"
+
+// --- Mapa de calor ---
+// Para cenas com muitas bolas: as posições são agrupadas num histograma 2D
+// de baixa resolução sobre o mundo (em paralelo, um histograma por thread
+// somados no fim), pintado com um mapa de cores e enviado como uma única
+// textura por quadro. O custo de desenho não depende do número de bolas.
+typedef enum HeatmapQuantity {
+    HEATMAP_DENSITY,      // Bolas por célula.
+    HEATMAP_ENERGY,       // Energia cinética somada por célula.
+    HEATMAP_QUANTITY_COUNT
+} HeatmapQuantity;
+
+// Colunas do histograma; as linhas seguem a proporção do mundo.
+#define HEATMAP_COLUMNS 256
+
+extern HeatmapQuantity heatmapQuantity;   // [H] alterna no modo mapa de calor.
+
+const char *HeatmapQuantityName(HeatmapQuantity quantity);
+// Atualiza a textura e a desenha sobre o retângulo do mundo (em coordenadas
+// do mundo, dentro de BeginMode2D).
+void DrawHeatmap(const Ball balls[], int numBalls);
+void HeatmapShutdown(void);
+
+#endif
@@ -1,169 +1,687 @@
 #include "raylib.h"
+#include "sim.h"
+#include "bench.h"
+#include "profiler.h"
+#include "trace.h"
+#include "perfcounters.h"
+#include "headless.h"
+#include "grid.h"
+#include "statehash.h"
+#include "snapshot.h"
+#include "trajectory.h"
+#include "rewind.h"
+#include "render.h"
+#include "view.h"
+#include "heatmap.h"
+#include "threadpool.h"
+#include "softraster.h"
+#include "placement.h"
+#include "observables.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <time.h>
 
 // --- Configurações da Simulação ---
 // Define parâmetros como tamanho da tela, número de bolas, elasticidade das colisões e limites de tamanho/velocidade.
-const int WIDTH = 800;
-const int HEIGHT = 600;
+// O tamanho do mundo e o número de bolas podem ser trocados por linha de comando (--world, --balls).
+int WIDTH = 800;
+int HEIGHT = 600;
 const int NUM_BALLS = 10;
 const float RESTITUTION_COEFFICIENT = 1.0f; 
 const int MIN_BALL_RADIUS = 15;
 const int MAX_BALL_RADIUS = 35;
 const float VELOCITY_SCALE = 200.0f;
 bool showDebugInfo = true;
+int traceFrames = 120;   // Quadros gravados por captura de trace ([T] ou --trace N).
+BroadphaseMode broadphaseMode = BROADPHASE_ALL_PAIRS;   // [G] ou --broadphase alterna.
+float gridCellSize = 0.0f;   // Lado da célula da grade; 0 usa o maior diâmetro possível.
+CollisionCounters stepCounters = { 0 };
+CollisionCounters totalCounters = { 0 };
+SystemTotals systemTotals = { 0 };
+int energyCheckEvery = 1000;   // Passos entre conferências de systemTotals (--energy-check N).
+double wallImpulse = 0.0;
+double simTime = 0.0;
+unsigned int simSeed = 0;      // Semente do gerador (--seed); por padrão vem do relógio.
+float fixedDeltaTime = 0.0f;   // Passo fixo em segundos (--dt); 0 usa GetFrameTime na janela.
+long long simStep = 0;         // Passos simulados desde o último InitBalls.
+int hashEvery = 0;             // Imprime o hash do estado a cada N passos (--hash N).
+uint64_t lastStateHash = 0;
+const char *snapshotPath = "snapshot.sim";   // Arquivo de [F5]/[F9] e de --save.
+RenderMode renderMode = RENDER_CIRCLES;   // [V] ou --render troca.
+HeatmapQuantity heatmapQuantity = HEATMAP_DENSITY;   // [H] troca no modo mapa de calor.
+InitOptions initOptions = { LAYOUT_RANDOM, 0.5f, 0.0f };   // --layout, --packing, --temperature.
+bool simPaused = false;        // [Espaço] pausa; as setas rebobinam/avançam passo a passo.
 
-// Estrutura que define as propriedades de uma bola.
-typedef struct Ball {
-    Vector2 position;
-    Vector2 velocity;
-    int radius;
-    float mass;
-    Color color;
-} Ball;
+// Limite de passos fixos por quadro, para a simulação não entrar em espiral
+// quando um quadro demora mais do que o passo.
+#define MAX_STEPS_PER_FRAME 8
 
-// Declaração das funções para que possam ser usadas antes de suas definições no código.
-void InitBalls(Ball balls[], int numBalls);
-void UpdateFrame(Ball balls[], int numBalls);
-void DrawFrame(Ball balls[], int numBalls, float kineticEnergy);
-void CheckBallCollision(Ball *ball1, Ball *ball2);
-void CheckWallCollision(Ball *ball);
-float CalculateTotalKineticEnergy(Ball balls[], int numBalls);
+// Janela mínima, em segundos simulados, da pressão mostrada no HUD.
+#define THERMO_HUD_WINDOW 0.5
+
+// Posições sorteadas por bola no InitBalls antes de desistir dela (no RSA,
+// que busca frações de área altas, bem mais).
+#define INIT_ATTEMPTS 100
+#define RSA_ATTEMPTS 2000
+// Bolas seguidas sem lugar a partir das quais o RSA é dado como emperrado.
+#define RSA_MAX_FAILURES 200
+
+static SpatialGrid broadphaseGrid = { 0 };
+static long long gridStep = -1;   // Passo cujas posições estão em broadphaseGrid (-1: nenhum).
+static Ball *visibleBalls = NULL;  // Bolas na tela, copiadas a cada quadro por CollectVisibleBalls.
+static int visibleCapacity = 0;
+static Vector2 *previousPositions = NULL;   // Posições antes do último passo fixo.
+static int previousCount = 0;               // Bolas em previousPositions (0: inválidas).
+static int previousCapacity = 0;
+
+static void CollideWithGrid(Ball balls[], int numBalls, const SpatialGrid *grid, CollisionCounters *counters);
+static void ApplySnapshotInfo(const SnapshotInfo *info, bool adoptDeltaTime);
+static void TrackVelocityChange(float mass, Vector2 before, Vector2 after);
+static void SavePreviousPositions(const Ball balls[], int numBalls);
 
 
 //==================================================================================
 // Função Principal: Inicializa a janela, o loop do jogo e gerencia as chamadas
 // de update, cálculo de energia e desenho a cada quadro.
+// Com --bench-kernels, roda apenas os microbenchmarks dos kernels, sem janela.
+// Com --headless, simula --steps passos sem janela e grava o CSV de benchmark.
+// Com --trace N, grava um trace dos N primeiros quadros.
+// Com --seed e --dt, a execução é determinística e pode ser comparada pelo
+// hash do estado (--hash N). A energia e o momento mostrados são mantidos
+// pelas colisões e conferidos a cada --energy-check passos. --load parte de
+// um snapshot em vez de InitBalls e --save grava um snapshot ao fim da
+// execução sem janela. --traj grava posições e velocidades a cada
+// --traj-every passos; com --traj-format delta, só as posições, quantizadas
+// em --traj-precision (fração do maior lado do mundo) e comprimidas.
+// --traj-dump arquivo N mostra o quadro N de uma trajetória delta.
+// Na janela com --dt, um anel de quadros-chave (--rewind-mb, --rewind-every)
+// permite voltar no tempo. Sem janela, --checkpoint grava um checkpoint a cada
+// --checkpoint-every passos e --resume continua uma execução interrompida.
+// --render sprites desenha as bolas em lote, como quads texturizados,
+// --render lod tessela cada bola conforme o tamanho na tela e --render calor
+// troca as bolas por um mapa de calor da densidade ([H] alterna para energia).
+// Sem janela, --frames quadro.png (ou .ppm) grava a cada --frames-every passos
+// uma imagem desenhada na CPU, do tamanho da janela ou de --frames-size LxA.
+// --layout hex|quadrada|rsa troca o sorteio inicial por uma rede ou por RSA
+// com fração de área --packing, e --temperature T sorteia as velocidades
+// com energia cinética média T por bola.
 //==================================================================================
-int main(void) {
-    InitWindow(WIDTH, HEIGHT, "Simulador de Colisões com Energia Cinética");
+int main(int argc, char *argv[]) {
+    bool traceAtStartup = false;
+    bool seedGiven = false;
+    bool headless = false;
+    bool usePerfCounters = false;
+    bool saveAtEnd = false;
+    const char *loadPath = NULL;
+    bool resume = false;
+    SnapshotRun resumeRun = { 0 };
+    TrajectoryOptions trajectory = { NULL, 10, 8, TRAJECTORY_RAW, 1e-5f, 32 };
+    FrameExportOptions frames = { NULL, 100, 0, 0 };
+    int numBalls = NUM_BALLS;
+    int rewindMegabytes = 64;
+    int rewindEvery = 60;
+    HeadlessOptions headlessOptions = { 1000, 100, NULL, NULL, 10000, NULL };
+
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = (i + 1 < argc);
+        if (strcmp(argv[i], "--bench-kernels") == 0) return RunKernelBenchmarks();
+        else if (strcmp(argv[i], "--headless") == 0) headless = true;
+        else if (strcmp(argv[i], "--perf") == 0) usePerfCounters = true;
+        else if (strcmp(argv[i], "--trace") == 0 && hasValue) {
+            traceFrames = atoi(argv[++i]);
+            traceAtStartup = true;
+        }
+        else if (strcmp(argv[i], "--balls") == 0 && hasValue) numBalls = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--world") == 0 && hasValue) sscanf(argv[++i], "%dx%d", &WIDTH, &HEIGHT);
+        else if (strcmp(argv[i], "--steps") == 0 && hasValue) headlessOptions.steps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--report") == 0 && hasValue) headlessOptions.reportEvery = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--csv") == 0 && hasValue) headlessOptions.csvPath = argv[++i];
+        else if (strcmp(argv[i], "--broadphase") == 0 && hasValue) {
+            broadphaseMode = (strcmp(argv[++i], "grade") == 0) ? BROADPHASE_GRID : BROADPHASE_ALL_PAIRS;
+        }
+        else if (strcmp(argv[i], "--cell") == 0 && hasValue) gridCellSize = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            simSeed = (unsigned int)strtoul(argv[++i], NULL, 10);
+            seedGiven = true;
+        }
+        else if (strcmp(argv[i], "--dt") == 0 && hasValue) fixedDeltaTime = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--hash") == 0 && hasValue) hashEvery = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--energy-check") == 0 && hasValue) energyCheckEvery = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--load") == 0 && hasValue) loadPath = argv[++i];
+        else if (strcmp(argv[i], "--resume") == 0 && hasValue) {
+            loadPath = argv[++i];
+            resume = true;
+            headless = true;
+        }
+        else if (strcmp(argv[i], "--checkpoint") == 0 && hasValue) headlessOptions.checkpointPath = argv[++i];
+        else if (strcmp(argv[i], "--checkpoint-every") == 0 && hasValue) headlessOptions.checkpointEvery = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--traj") == 0 && hasValue) trajectory.path = argv[++i];
+        else if (strcmp(argv[i], "--traj-every") == 0 && hasValue) trajectory.every = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--traj-buffers") == 0 && hasValue) trajectory.bufferCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--traj-format") == 0 && hasValue) {
+            trajectory.format = (strcmp(argv[++i], "delta") == 0) ? TRAJECTORY_DELTA : TRAJECTORY_RAW;
+        }
+        else if (strcmp(argv[i], "--traj-precision") == 0 && hasValue) trajectory.precision = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--traj-keyframe") == 0 && hasValue) trajectory.keyframeInterval = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--traj-dump") == 0 && i + 2 < argc) {
+            const char *path = argv[++i];
+            return DumpTrajectoryFrame(path, atoi(argv[++i]));
+        }
+        else if (strcmp(argv[i], "--render") == 0 && hasValue) {
+            const char *mode = argv[++i];
+            if (strcmp(mode, "sprites") == 0) renderMode = RENDER_SPRITES;
+            else if (strcmp(mode, "lod") == 0) renderMode = RENDER_LOD;
+            else if (strcmp(mode, "calor") == 0) renderMode = RENDER_HEATMAP;
+            else renderMode = RENDER_CIRCLES;
+        }
+        else if (strcmp(argv[i], "--layout") == 0 && hasValue) {
+            if (!ParseInitLayout(argv[++i], &initOptions.layout)) {
+                fprintf(stderr, "Configuração inicial desconhecida: %s (use aleatorio, hex, quadrada ou rsa)\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--packing") == 0 && hasValue) initOptions.packing = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--temperature") == 0 && hasValue) initOptions.temperature = (float)atof(argv[++i]);
+        else if (strcmp(argv[i], "--frames") == 0 && hasValue) frames.path = argv[++i];
+        else if (strcmp(argv[i], "--frames-every") == 0 && hasValue) frames.every = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--frames-size") == 0 && hasValue) sscanf(argv[++i], "%dx%d", &frames.width, &frames.height);
+        else if (strcmp(argv[i], "--rewind-mb") == 0 && hasValue) rewindMegabytes = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--rewind-every") == 0 && hasValue) rewindEvery = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--save") == 0 && hasValue) {
+            snapshotPath = argv[++i];
+            saveAtEnd = true;
+        }
+        else {
+            fprintf(stderr, "Opção desconhecida: %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (gridCellSize <= 0.0f) gridCellSize = 2.0f * MAX_BALL_RADIUS;
+    if (!seedGiven) simSeed = (unsigned int)time(NULL);
+    if (numBalls <= 0 || WIDTH <= 2 * MAX_BALL_RADIUS || HEIGHT <= 2 * MAX_BALL_RADIUS) {
+        fprintf(stderr, "Número de bolas ou tamanho do mundo inválido\n");
+        return 1;
+    }
+
+    // InitBalls pode colocar menos bolas que as pedidas (sem espaço, ou o RSA
+    // parando em --packing); [R] volta a pedir o número original.
+    int requestedBalls = numBalls;
+    Ball *balls = (Ball *)malloc(sizeof(Ball) * numBalls);
+    if (balls == NULL) {
+        fprintf(stderr, "Memória insuficiente para %d bolas\n", numBalls);
+        return 1;
+    }
+    int ballCapacity = numBalls;
+    // Antes de qualquer ParallelFor: as threads do pool abrem seus contadores ao nascer.
+    if (usePerfCounters) PerfCountersInit();
+
+    // Um snapshot traz a referência da deriva da execução que o gravou; sem
+    // ela (InitBalls ou arquivo antigo), a deriva passa a contar daqui.
+    DriftReference loadedDrift = { 0 };
+    bool hasLoadedDrift = false;
+    if (loadPath != NULL) {
+        SnapshotInfo info;
+        if (!LoadSnapshot(loadPath, &balls, &numBalls, &info)) {
+            free(balls);
+            return 1;
+        }
+        ballCapacity = numBalls;
+        if (resume) {
+            // Continua exatamente como a execução original: mesmo dt,
+            // broadphase e contadores, e o checkpoint segue no mesmo arquivo.
+            if (info.run.endStep <= 0) {
+                fprintf(stderr, "%s não é um checkpoint de execução sem janela\n", loadPath);
+                free(info.run.energyHistory);
+                free(balls);
+                return 1;
+            }
+            ApplySnapshotInfo(&info, true);
+            broadphaseMode = info.broadphaseMode;
+            gridCellSize = info.cellSize;
+            totalCounters = info.totals;
+            // Os intervalos também seguem os do checkpoint; mudá-los no meio
+            // mudaria as linhas do CSV e as amostras do histórico.
+            if (info.run.reportEvery > 0) {
+                if (headlessOptions.reportEvery != info.run.reportEvery) {
+                    printf("Usando --report %d do checkpoint\n", info.run.reportEvery);
+                }
+                headlessOptions.reportEvery = info.run.reportEvery;
+            }
+            if (info.run.energyCheckEvery >= 0) {
+                if (energyCheckEvery != info.run.energyCheckEvery) {
+                    printf("Usando --energy-check %d do checkpoint\n", info.run.energyCheckEvery);
+                }
+                energyCheckEvery = info.run.energyCheckEvery;
+            }
+            resumeRun = info.run;
+            headlessOptions.resume = &resumeRun;
+            if (headlessOptions.checkpointPath == NULL) headlessOptions.checkpointPath = loadPath;
+        } else {
+            ApplySnapshotInfo(&info, fixedDeltaTime <= 0.0f);
+            free(info.run.energyHistory);
+        }
+        loadedDrift = info.drift;
+        hasLoadedDrift = info.hasDriftReference;
+    } else {
+        numBalls = InitBalls(balls, numBalls);
+        if (numBalls == 0) {
+            free(balls);
+            return 1;
+        }
+    }
+    SyncSystemTotals(balls, numBalls);
+    if (hasLoadedDrift) SetDriftReference(loadedDrift);
+    else ResetDriftReference();
+    if (headless && fixedDeltaTime <= 0.0f) fixedDeltaTime = HEADLESS_DELTA_TIME;
+    if (trajectory.path != NULL && !TrajectoryStart(&trajectory)) {
+        free(balls);
+        return 1;
+    }
+
+    if (headless) {
+        if (frames.path != NULL && !FrameExportStart(&frames)) {
+            TrajectoryStop();
+            free(balls);
+            return 1;
+        }
+        if (traceAtStartup) TraceStartCapture(traceFrames);
+        int result = RunHeadless(balls, numBalls, &headlessOptions);
+        if (saveAtEnd && !SaveSnapshot(snapshotPath, balls, numBalls, NULL)) result = 1;
+        free(resumeRun.energyHistory);
+        TrajectoryStop();
+        FrameExportStop();
+        ThreadPoolShutdown();
+        TraceShutdown();
+        PerfCountersShutdown();
+        FreeSpatialGrid(&broadphaseGrid);
+        free(balls);
+        return result;
+    }
+
+    InitWindow((WIDTH < MAX_WINDOW_WIDTH) ? WIDTH : MAX_WINDOW_WIDTH, (HEIGHT < MAX_WINDOW_HEIGHT) ? HEIGHT : MAX_WINDOW_HEIGHT,
+               "Simulador de Colisões com Energia Cinética");
     SetTargetFPS(144);
-    SetRandomSeed((unsigned int)time(NULL));
+    RenderInit();
+    ViewFit();
 
-    Ball balls[NUM_BALLS];
-    InitBalls(balls, NUM_BALLS);
+    if (traceAtStartup) TraceStartCapture(traceFrames);
+    float accumulator = 0.0f;
+
+    // A rebobinagem refaz passos a partir dos quadros-chave, então só é
+    // exata com passo fixo.
+    if (fixedDeltaTime > 0.0f && rewindMegabytes > 0 && RewindInit((size_t)rewindMegabytes << 20, rewindEvery)) {
+        RewindReset(balls, numBalls, simStep);
+    }
 
     while (!WindowShouldClose()) {
-        if (IsKeyPressed(KEY_R)) InitBalls(balls, NUM_BALLS);
+        if (IsKeyPressed(KEY_R)) {
+            if (requestedBalls > ballCapacity) {
+                Ball *grown = (Ball *)realloc(balls, sizeof(Ball) * requestedBalls);
+                if (grown != NULL) {
+                    balls = grown;
+                    ballCapacity = requestedBalls;
+                }
+            }
+            numBalls = InitBalls(balls, (requestedBalls < ballCapacity) ? requestedBalls : ballCapacity);
+            simStep = 0;
+            wallImpulse = 0.0;
+            simTime = 0.0;
+            SyncSystemTotals(balls, numBalls);
+            ResetDriftReference();
+            gridStep = -1;
+            previousCount = 0;
+            accumulator = 0.0f;
+            RewindReset(balls, numBalls, simStep);
+        }
         if (IsKeyPressed(KEY_D)) showDebugInfo = !showDebugInfo;
-        
-        UpdateFrame(balls, NUM_BALLS);
+        if (IsKeyPressed(KEY_T)) TraceStartCapture(traceFrames);
+        if (IsKeyPressed(KEY_V)) renderMode = (RenderMode)((renderMode + 1) % RENDER_MODE_COUNT);
+        if (IsKeyPressed(KEY_H)) heatmapQuantity = (HeatmapQuantity)((heatmapQuantity + 1) % HEATMAP_QUANTITY_COUNT);
+        if (IsKeyPressed(KEY_G)) {
+            broadphaseMode = (broadphaseMode == BROADPHASE_GRID) ? BROADPHASE_ALL_PAIRS : BROADPHASE_GRID;
+            RewindMark(balls, numBalls, simStep);
+        }
+        if (IsKeyPressed(KEY_F5) && SaveSnapshot(snapshotPath, balls, numBalls, NULL)) {
+            TraceLog(LOG_INFO, "SNAPSHOT: passo %lld gravado em %s", simStep, snapshotPath);
+        }
+        if (IsKeyPressed(KEY_F9)) {
+            SnapshotInfo info;
+            if (LoadSnapshot(snapshotPath, &balls, &numBalls, &info)) {
+                ballCapacity = numBalls;
+                ApplySnapshotInfo(&info, false);
+                free(info.run.energyHistory);
+                SyncSystemTotals(balls, numBalls);
+                if (info.hasDriftReference) SetDriftReference(info.drift);
+                else ResetDriftReference();
+                gridStep = -1;
+                previousCount = 0;
+                accumulator = 0.0f;
+                ViewFit();
+                RewindReset(balls, numBalls, simStep);
+            }
+        }
+        if (IsKeyPressed(KEY_SPACE)) {
+            simPaused = !simPaused;
+            previousCount = 0;
+        }
+        ViewHandleInput();
+        if (RewindEnabled()) {
+            long long target = simStep;
+            if (IsKeyPressed(KEY_LEFT)) target = simStep - 1;
+            if (IsKeyPressed(KEY_RIGHT)) target = simStep + 1;
+            if (IsKeyPressed(KEY_PAGE_DOWN)) target = simStep - RewindInterval();
+            if (IsKeyPressed(KEY_PAGE_UP)) target = simStep + RewindInterval();
+            if (target != simStep) {
+                simPaused = true;
+                previousCount = 0;
+                RewindSeek(balls, numBalls, target);
+            }
+        }
 
-        float totalKE = CalculateTotalKineticEnergy(balls, NUM_BALLS);
-        
-        DrawFrame(balls, NUM_BALLS, totalKE);
+        // No modo de passo fixo, o tempo do quadro é consumido em passos
+        // inteiros de fixedDeltaTime; o resto fica para o próximo quadro. As
+        // posições de antes do último passo do quadro são guardadas para o
+        // desenho interpolar entre elas e as atuais.
+        if (simPaused) {
+            accumulator = 0.0f;
+        } else if (fixedDeltaTime > 0.0f) {
+            accumulator += GetFrameTime();
+            int steps = 0;
+            while (accumulator >= fixedDeltaTime && steps < MAX_STEPS_PER_FRAME) {
+                bool lastStep = (accumulator < 2.0f * fixedDeltaTime || steps == MAX_STEPS_PER_FRAME - 1);
+                if (lastStep) SavePreviousPositions(balls, numBalls);
+                StepSimulation(balls, numBalls, fixedDeltaTime);
+                accumulator -= fixedDeltaTime;
+                steps++;
+            }
+            if (steps == MAX_STEPS_PER_FRAME) accumulator = fmodf(accumulator, fixedDeltaTime);
+        } else {
+            StepSimulation(balls, numBalls, GetFrameTime());
+        }
+
+        // O resto do acumulador diz quanto do próximo passo já passou: o
+        // desenho mostra o estado um passo atrás, interpolado por essa fração.
+        // Pausado ou com dt variável, desenha as posições atuais.
+        float alpha = 1.0f;
+        if (!simPaused && fixedDeltaTime > 0.0f) alpha = accumulator / fixedDeltaTime;
+        DrawFrame(balls, numBalls, (float)systemTotals.kineticEnergy, alpha);
+        PROFILE_FRAME();
+        TraceFrame();
     }
 
+    TrajectoryStop();
+    RewindShutdown();
+    ThreadPoolShutdown();
+    TraceShutdown();
+    PerfCountersShutdown();
+    RenderShutdown();
     CloseWindow();
+    FreeSpatialGrid(&broadphaseGrid);
+    free(visibleBalls);
+    free(previousPositions);
+    free(balls);
     return 0;
 }
 
+static void SavePreviousPositions(const Ball balls[], int numBalls) {
+    if (numBalls > previousCapacity) {
+        Vector2 *positions = (Vector2 *)realloc(previousPositions, sizeof(Vector2) * numBalls);
+        if (positions == NULL) {
+            previousCount = 0;
+            return;
+        }
+        previousPositions = positions;
+        previousCapacity = numBalls;
+    }
+    for (int i = 0; i < numBalls; i++) previousPositions[i] = balls[i].position;
+    previousCount = numBalls;
+}
+
 //==================================================================================
-// Calcula e retorna a soma da energia cinética (KE = 0.5*m*v^2) de todas as bolas.
+// Aplica os metadados de um snapshot carregado: passo, semente, tamanho do
+// mundo, impulso nas paredes e tempo simulado e, se pedido, o passo fixo com
+// que ele foi gerado.
 //==================================================================================
-float CalculateTotalKineticEnergy(Ball balls[], int numBalls) {
-    float totalEnergy = 0.0f;
-    for (int i = 0; i < numBalls; i++) {
-        float speedSq = balls[i].velocity.x * balls[i].velocity.x + balls[i].velocity.y * balls[i].velocity.y;
-        float kineticEnergy = 0.5f * balls[i].mass * speedSq;
-        totalEnergy += kineticEnergy;
+static void ApplySnapshotInfo(const SnapshotInfo *info, bool adoptDeltaTime) {
+    simStep = info->step;
+    wallImpulse = info->wallImpulse;
+    simTime = info->simTime;
+    simSeed = info->seed;
+    WIDTH = info->worldWidth;
+    HEIGHT = info->worldHeight;
+    if (adoptDeltaTime && info->deltaTime > 0.0f) fixedDeltaTime = info->deltaTime;
+}
+
+//==================================================================================
+// Avança a simulação um passo e, se pedido, registra o hash do estado e
+// entrega o quadro ao gravador de trajetória. A cada energyCheckEvery passos
+// confere os totais mantidos pelas colisões contra uma soma completa.
+//==================================================================================
+void StepSimulation(Ball balls[], int numBalls, float deltaTime) {
+    UpdateFrame(balls, numBalls, deltaTime);
+    simStep++;
+    if (energyCheckEvery > 0 && simStep % energyCheckEvery == 0) {
+        PROFILE_BEGIN(PHASE_ENERGY);
+        CheckSystemTotals(balls, numBalls);
+        PROFILE_END(PHASE_ENERGY);
+    }
+    TrajectoryRecord(balls, numBalls, simStep);
+    RewindRecord(balls, numBalls, simStep);
+
+    if (hashEvery > 0 && simStep % hashEvery == 0) {
+        lastStateHash = HashBallState(balls, numBalls);
+        printf("passo %lld hash %016llx\n", simStep, (unsigned long long)lastStateHash);
     }
-    return totalEnergy;
 }
 
 //==================================================================================
 // Atualiza a lógica da simulação a cada quadro: move as bolas com base na
 // velocidade e depois verifica e resolve as colisões entre elas e com as paredes.
+// Os pares testados vêm da broadphase escolhida; os contadores do passo
+// ficam em stepCounters.
 //==================================================================================
-void UpdateFrame(Ball balls[], int numBalls) {
-    float deltaTime = GetFrameTime();
+void UpdateFrame(Ball balls[], int numBalls, float deltaTime) {
+    CollisionCounters counters = { 0 };
+    simTime += deltaTime;
 
+    PROFILE_BEGIN(PHASE_INTEGRATION);
     for (int i = 0; i < numBalls; i++) {
         balls[i].position.x += balls[i].velocity.x * deltaTime;
         balls[i].position.y += balls[i].velocity.y * deltaTime;
     }
+    PROFILE_END(PHASE_INTEGRATION);
 
+    PROFILE_BEGIN(PHASE_BROADPHASE);
+    bool useGrid = (broadphaseMode == BROADPHASE_GRID) && BuildSpatialGrid(&broadphaseGrid, balls, numBalls, gridCellSize);
+    if (useGrid) gridStep = simStep + 1;
+    PROFILE_END(PHASE_BROADPHASE);
+
+    PROFILE_BEGIN(PHASE_NARROWPHASE);
+    if (useGrid) {
+        CollideWithGrid(balls, numBalls, &broadphaseGrid, &counters);
+    } else {
+        counters.candidatePairs = (long long)numBalls * (numBalls - 1) / 2;
+        for (int i = 0; i < numBalls; i++) {
+            CheckWallCollision(&balls[i]);
+            for (int j = i + 1; j < numBalls; j++) {
+                CollisionResult result = CheckBallCollision(&balls[i], &balls[j]);
+                counters.overlappingPairs += (result != COLLISION_NONE);
+                counters.impulsePairs += (result == COLLISION_IMPULSE);
+            }
+        }
+    }
+    PROFILE_END(PHASE_NARROWPHASE);
+
+    stepCounters = counters;
+    totalCounters.candidatePairs += counters.candidatePairs;
+    totalCounters.overlappingPairs += counters.overlappingPairs;
+    totalCounters.impulsePairs += counters.impulsePairs;
+}
+
+//==================================================================================
+// Narrowphase com a grade: cada bola testa só as bolas de índice maior nas
+// células vizinhas, na mesma ordem (parede antes dos pares) do laço O(n²).
+//==================================================================================
+static void CollideWithGrid(Ball balls[], int numBalls, const SpatialGrid *grid, CollisionCounters *counters) {
     for (int i = 0; i < numBalls; i++) {
         CheckWallCollision(&balls[i]);
-        for (int j = i + 1; j < numBalls; j++) {
-            CheckBallCollision(&balls[i], &balls[j]);
+
+        int col = grid->ballCell[i] % grid->cols;
+        int row = grid->ballCell[i] / grid->cols;
+        int colMin = (col - grid->reach > 0) ? col - grid->reach : 0;
+        int colMax = (col + grid->reach < grid->cols - 1) ? col + grid->reach : grid->cols - 1;
+        int rowMin = (row - grid->reach > 0) ? row - grid->reach : 0;
+        int rowMax = (row + grid->reach < grid->rows - 1) ? row + grid->reach : grid->rows - 1;
+
+        for (int r = rowMin; r <= rowMax; r++) {
+            for (int c = colMin; c <= colMax; c++) {
+                int cell = r * grid->cols + c;
+                for (int k = grid->cellStart[cell]; k < grid->cellStart[cell + 1]; k++) {
+                    int j = grid->cellBalls[k];
+                    if (j <= i) continue;
+                    counters->candidatePairs++;
+                    CollisionResult result = CheckBallCollision(&balls[i], &balls[j]);
+                    counters->overlappingPairs += (result != COLLISION_NONE);
+                    counters->impulsePairs += (result == COLLISION_IMPULSE);
+                }
+            }
         }
     }
 }
 
 //==================================================================================
 // Desenha todos os elementos na tela: o fundo, as bolas e os textos de
-// informação (FPS, energia, controles, etc.).
+// informação (FPS, energia, controles, etc.). O tempo medido para a fase de
+// desenho exclui EndDrawing, que também espera pelo FPS alvo.
+// Só as bolas dentro da câmera são desenhadas, obtidas pela grade espacial
+// (a da broadphase, se ainda vale para o passo atual, ou uma nova), e só
+// elas são interpoladas. O mapa de calor usa as posições atuais: a fração
+// de passo não aparece na densidade.
+// Sem posições anteriores válidas (logo após R, F9 ou rebobinar), desenha
+// as atuais.
 //==================================================================================
-void DrawFrame(Ball balls[], int numBalls, float kineticEnergy) {
+void DrawFrame(Ball balls[], int numBalls, float kineticEnergy, float alpha) {
+    PROFILE_BEGIN(PHASE_DRAW);
+    Camera2D camera = ViewCamera();
+    const Ball *drawn = balls;
+    int drawnCount = numBalls;
+    bool cull = (renderMode != RENDER_HEATMAP);
+    const Vector2 *previous = (alpha < 1.0f && previousCount == numBalls) ? previousPositions : NULL;
+    if (cull && gridStep != simStep && BuildSpatialGrid(&broadphaseGrid, balls, numBalls, gridCellSize)) gridStep = simStep;
+    if (cull && gridStep == simStep) {
+        int visible = CollectVisibleBalls(balls, &broadphaseGrid, previous, alpha, &visibleBalls, &visibleCapacity);
+        if (visible >= 0) {
+            drawn = visibleBalls;
+            drawnCount = visible;
+        }
+    }
+
+    bool labels = showDebugInfo && renderMode != RENDER_HEATMAP;
+    if (labels) UpdateMassLabels(drawn, drawnCount, camera.zoom);
+    UpdateStaticHud(numBalls);
     BeginDrawing();
     ClearBackground(BLACK);
 
-    for (int i = 0; i < numBalls; i++) {
-        DrawCircleV(balls[i].position, balls[i].radius, balls[i].color);
-        if (showDebugInfo) {
-            DrawText(TextFormat("M:%.1f", balls[i].mass), balls[i].position.x - 15, balls[i].position.y - 8, 10, WHITE);
-        }
-    }
-    
+    BeginMode2D(camera);
+    DrawBalls(drawn, drawnCount, camera.zoom);
     DrawRectangleLines(0, 0, WIDTH, HEIGHT, DARKGRAY);
-    DrawText(TextFormat("Bolinhas: %d", NUM_BALLS), 10, 10, 20, RAYWHITE);
-    DrawText(TextFormat("Restituição: %.2f", RESTITUTION_COEFFICIENT), 10, 35, 20, RAYWHITE);
+    EndMode2D();
+    if (labels) DrawMassLabels(drawn, drawnCount, camera);
+
+    int screenWidth = GetScreenWidth();
+    DrawStaticHud();
     DrawText(TextFormat("Energia Cinética Total: %.0f", kineticEnergy), 10, 60, 20, LIME);
-    DrawFPS(WIDTH - 90, 10);
-    DrawText("Pressione [R] para reiniciar", WIDTH - 170, 40, 10, GRAY);
-    DrawText("Pressione [D] para info", WIDTH - 170, 55, 10, GRAY);
+    Thermodynamics thermo = SampleThermodynamics(numBalls, THERMO_HUD_WINDOW);
+    DrawText(TextFormat("Temperatura %.4g, momento (%.4g, %.4g), pressão nas paredes %.4g (PA/NT = %.3f)", thermo.temperature,
+                        thermo.momentumX, thermo.momentumY, thermo.pressure, thermo.compressibility), 10, 85, 10, LIME);
+    DrawFPS(screenWidth - 90, 10);
+    if (TraceIsCapturing()) DrawText("Gravando trace...", screenWidth - 170, 160, 10, RED);
+    if (simPaused) DrawText(TextFormat("PAUSADO - passo %lld", simStep), screenWidth / 2 - 80, 10, 20, YELLOW);
+    if (showDebugInfo) {
+        long long candidates = stepCounters.candidatePairs;
+        DrawText(TextFormat("Broadphase %s: %lld candidatos, %lld contatos (%.2f%%), %lld impulsos",
+                            (broadphaseMode == BROADPHASE_GRID) ? "grade" : "todos os pares", candidates,
+                            stepCounters.overlappingPairs, candidates ? 100.0 * stepCounters.overlappingPairs / candidates : 0.0,
+                            stepCounters.impulsePairs), 10, 100, 10, RAYWHITE);
+        EnergyDrift drift = GetEnergyDrift();
+        DrawText(TextFormat("Semente %u, passo %lld, %s, hash %016llx, deriva de energia %+.2e por 10^6 passos", simSeed,
+                            simStep, (fixedDeltaTime > 0.0f) ? TextFormat("dt fixo %.5f s", fixedDeltaTime) : "dt variável",
+                            (unsigned long long)lastStateHash, drift.perMillionSteps), 10, 115, 10, RAYWHITE);
+        if (RewindEnabled()) {
+            RewindStats rewindStats = RewindGetStats();
+            DrawText(TextFormat("Rebobinagem: passos %lld a %lld, %d/%d quadros-chave a cada %d passos (%.1f MB)",
+                                rewindStats.oldestStep, simStep > rewindStats.newestStep ? simStep : rewindStats.newestStep,
+                                rewindStats.keyframes, rewindStats.capacity, RewindInterval(), rewindStats.bytes / 1048576.0),
+                     10, 130, 10, RAYWHITE);
+        } else {
+            DrawText("Rebobinagem desligada (requer --dt)", 10, 130, 10, GRAY);
+        }
+        DrawText(TextFormat("Desenho %s: %lld vértices, %d de %d bolas na tela, zoom %.2f", RenderModeName(renderMode),
+                            RenderVertexCount(), drawnCount, numBalls, camera.zoom), 10, 145, 10, RAYWHITE);
+        PROFILE_DRAW_OVERLAY(10, 160);
+    }
 
+    PROFILE_END(PHASE_DRAW);
     EndDrawing();
 }
 
 //==================================================================================
-// Inicializa (ou reinicializa) as bolas com posições, raios, massas e
-// velocidades aleatórias, garantindo que não comecem sobrepostas.
+// Inicializa (ou reinicializa) as bolas na configuração de initOptions (ver
+// placement.h), garantindo que não comecem sobrepostas: as bolas que não
+// couberem são descartadas e as posicionadas ficam no começo do vetor.
+// Cores e velocidades são sorteadas depois das posições. Retorna quantas
+// bolas foram posicionadas.
 //==================================================================================
-void InitBalls(Ball balls[], int numBalls) {
-    for (int i = 0; i < numBalls; i++) {
-        balls[i].radius = GetRandomValue(MIN_BALL_RADIUS, MAX_BALL_RADIUS);
-        balls[i].mass = (float)balls[i].radius / 2.0f;
-
-        bool positionFound = false;
-        int attempts = 0;
-        while (!positionFound && attempts < 100) {
-            balls[i].position = (Vector2){
-                (float)GetRandomValue(balls[i].radius, WIDTH - balls[i].radius),
-                (float)GetRandomValue(balls[i].radius, HEIGHT - balls[i].radius)
-            };
-            
-            positionFound = true;
-            for (int j = 0; j < i; j++) {
-                float distSq = (balls[i].position.x - balls[j].position.x) * (balls[i].position.x - balls[j].position.x) +
-                                   (balls[i].position.y - balls[j].position.y) * (balls[i].position.y - balls[j].position.y);
-                float min_dist = (float)(balls[i].radius + balls[j].radius);
-                
-                if (distSq < min_dist * min_dist) {
-                    positionFound = false;
-                    break;
-                }
-            }
-            attempts++;
-        }
-        
-        balls[i].velocity = (Vector2){
-            (float)GetRandomValue(-VELOCITY_SCALE, VELOCITY_SCALE),
-            (float)GetRandomValue(-VELOCITY_SCALE, VELOCITY_SCALE)
-        };
+int InitBalls(Ball balls[], int numBalls) {
+    static uint64_t generation = 0;   // Cada [R] sorteia uma configuração nova, mas reproduzível.
+    InitLayout layout = initOptions.layout;
+    int placed;
+    if (layout == LAYOUT_HEX || layout == LAYOUT_SQUARE) {
+        placed = PlaceBallsLattice(balls, numBalls, layout, initOptions.packing);
+    } else if (layout == LAYOUT_RSA) {
+        placed = PlaceBallsRandom(balls, numBalls, RSA_ATTEMPTS, initOptions.packing, RSA_MAX_FAILURES, generation);
+    } else {
+        placed = PlaceBallsRandom(balls, numBalls, INIT_ATTEMPTS, 1.0f, 0, generation);
+    }
 
-        balls[i].color = (Color){ (unsigned char)GetRandomValue(100, 255), (unsigned char)GetRandomValue(100, 255), (unsigned char)GetRandomValue(100, 255), 255 };
+    DrawAppearance(balls, placed, generation);
+    if (initOptions.temperature > 0.0f) DrawThermalVelocities(balls, placed, initOptions.temperature, generation);
+    generation++;
+
+    if (layout == LAYOUT_RANDOM) {
+        if (placed < numBalls) {
+            fprintf(stderr, "%d de %d bolas não couberam sem sobreposição em %d tentativas; simulando com %d\n",
+                    numBalls - placed, numBalls, INIT_ATTEMPTS, placed);
+        }
+    } else {
+        printf("Configuração %s: %d de %d bolas, fração de área %.4f (alvo %.4f)\n", InitLayoutName(layout), placed,
+               numBalls, AreaFraction(balls, placed), initOptions.packing);
     }
+    return placed;
+}
+
+//==================================================================================
+// Acrescenta a systemTotals a variação de energia e momento de uma bola cuja
+// velocidade mudou, calculada das próprias velocidades em float para
+// acompanhar exatamente o que a simulação fez.
+//==================================================================================
+static void TrackVelocityChange(float mass, Vector2 before, Vector2 after) {
+    double speedBefore = (double)before.x * before.x + (double)before.y * before.y;
+    double speedAfter = (double)after.x * after.x + (double)after.y * after.y;
+    systemTotals.kineticEnergy += 0.5 * mass * (speedAfter - speedBefore);
+    systemTotals.momentumX += (double)mass * ((double)after.x - before.x);
+    systemTotals.momentumY += (double)mass * ((double)after.y - before.y);
 }
 
 //==================================================================================
 // Verifica a colisão entre duas bolas. Se colidirem, corrige a sobreposição
 // e calcula suas novas velocidades com base na física de colisão elástica.
+// Retorna se houve contato e se ele resultou em troca de impulso.
 //==================================================================================
-void CheckBallCollision(Ball *b1, Ball *b2) {
+CollisionResult CheckBallCollision(Ball *b1, Ball *b2) {
     float dx = b2->position.x - b1->position.x;
     float dy = b2->position.y - b1->position.y;
     float distSq = dx * dx + dy * dy;
@@ -189,17 +707,23 @@ void CheckBallCollision(Ball *b1, Ball *b2) {
         float velocityAlongNormal = relativeVelocity.x * nx + relativeVelocity.y * ny;
         
         // Não faz nada se as velocidades já estão se separando
-        if (velocityAlongNormal > 0) return;
+        if (velocityAlongNormal > 0) return COLLISION_OVERLAP;
         
         // Calcula o impulso da colisão
         float impulse = -(1.0f + RESTITUTION_COEFFICIENT) * velocityAlongNormal / (1.0f / b1->mass + 1.0f / b2->mass);
         
         // Aplica o impulso para atualizar as velocidades das bolas
+        Vector2 before1 = b1->velocity;
+        Vector2 before2 = b2->velocity;
         b1->velocity.x -= impulse * nx / b1->mass;
         b1->velocity.y -= impulse * ny / b1->mass;
         b2->velocity.x += impulse * nx / b2->mass;
         b2->velocity.y += impulse * ny / b2->mass;
+        TrackVelocityChange(b1->mass, before1, b1->velocity);
+        TrackVelocityChange(b2->mass, before2, b2->velocity);
+        return COLLISION_IMPULSE;
     }
+    return COLLISION_NONE;
 }
 
 //==================================================================================
@@ -207,6 +731,8 @@ void CheckBallCollision(Ball *b1, Ball *b2) {
 // no eixo correspondente para simular um rebote.
 //==================================================================================
 void CheckWallCollision(Ball *ball) {
+    Vector2 before = ball->velocity;
+
     // Colisão com as paredes verticais (esquerda e direita)
     if (ball->position.x - ball->radius <= 0) {
         ball->position.x = ball->radius;
@@ -224,4 +750,9 @@ void CheckWallCollision(Ball *ball) {
         ball->position.y = HEIGHT - ball->radius;
         ball->velocity.y *= -RESTITUTION_COEFFICIENT;
     }
+
+    if (ball->velocity.x != before.x || ball->velocity.y != before.y) {
+        TrackVelocityChange(ball->mass, before, ball->velocity);
+        wallImpulse += ball->mass * (fabsf(ball->velocity.x - before.x) + fabsf(ball->velocity.y - before.y));
+    }
 }
\ No newline at end of file
@@ -0,0 +1,168 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "mapped_file.h"
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+
+bool MapFileRead(MappedFile *file, const char *path) {
+    memset(file, 0, sizeof(*file));
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+        CloseHandle(handle);
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL) {
+        CloseHandle(handle);
+        return false;
+    }
+    void *data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL) {
+        CloseHandle(mapping);
+        CloseHandle(handle);
+        return false;
+    }
+
+    file->data = data;
+    file->size = (size_t)size.QuadPart;
+    file->handle = (intptr_t)handle;
+    file->mapping = (intptr_t)mapping;
+    return true;
+}
+
+bool MapFileCreate(MappedFile *file, const char *path, size_t size) {
+    memset(file, 0, sizeof(*file));
+    HANDLE handle = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+
+    // CreateFileMapping com tamanho maior que o arquivo já o estende.
+    HANDLE mapping = CreateFileMappingA(handle, NULL, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)(size & 0xFFFFFFFFu), NULL);
+    if (mapping == NULL) {
+        CloseHandle(handle);
+        return false;
+    }
+    void *data = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, size);
+    if (data == NULL) {
+        CloseHandle(mapping);
+        CloseHandle(handle);
+        return false;
+    }
+
+    file->data = data;
+    file->size = size;
+    file->writable = true;
+    file->handle = (intptr_t)handle;
+    file->mapping = (intptr_t)mapping;
+    return true;
+}
+
+bool UnmapFile(MappedFile *file) {
+    bool ok = true;
+    if (file->data != NULL) {
+        if (file->writable) ok = FlushViewOfFile(file->data, 0) && FlushFileBuffers((HANDLE)file->handle);
+        UnmapViewOfFile(file->data);
+    }
+    if (file->mapping) CloseHandle((HANDLE)file->mapping);
+    if (file->handle) CloseHandle((HANDLE)file->handle);
+    memset(file, 0, sizeof(*file));
+    return ok;
+}
+
+bool ReplaceFileAtomically(const char *from, const char *to) {
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+
+bool TruncateFile(const char *path, uint64_t size) {
+    HANDLE handle = CreateFileA(path, GENERIC_WRITE, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER current, end;
+    end.QuadPart = (LONGLONG)size;
+    bool ok = GetFileSizeEx(handle, &current) && (uint64_t)current.QuadPart >= size &&
+              SetFilePointerEx(handle, end, NULL, FILE_BEGIN) && SetEndOfFile(handle);
+    CloseHandle(handle);
+    return ok;
+}
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <stdio.h>
+
+bool MapFileRead(MappedFile *file, const char *path) {
+    memset(file, 0, sizeof(*file));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return false;
+    }
+    void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    file->data = data;
+    file->size = (size_t)info.st_size;
+    file->handle = fd;
+    return true;
+}
+
+bool MapFileCreate(MappedFile *file, const char *path, size_t size) {
+    memset(file, 0, sizeof(*file));
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        return false;
+    }
+    void *data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    file->data = data;
+    file->size = size;
+    file->writable = true;
+    file->handle = fd;
+    return true;
+}
+
+bool UnmapFile(MappedFile *file) {
+    bool ok = true;
+    if (file->data != NULL) {
+        if (file->writable) ok = (msync(file->data, file->size, MS_SYNC) == 0);
+        munmap(file->data, file->size);
+        close((int)file->handle);
+    }
+    memset(file, 0, sizeof(*file));
+    return ok;
+}
+
+bool ReplaceFileAtomically(const char *from, const char *to) {
+    return rename(from, to) == 0;
+}
+
+bool TruncateFile(const char *path, uint64_t size) {
+    int fd = open(path, O_WRONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    bool ok = fstat(fd, &info) == 0 && (uint64_t)info.st_size >= size && ftruncate(fd, (off_t)size) == 0;
+    close(fd);
+    return ok;
+}
+#endif
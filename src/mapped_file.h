@@ -0,0 +1,31 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// --- Arquivos mapeados em memória ---
+// Camada fina sobre mmap (POSIX) e CreateFileMapping (Windows). Fica num
+// arquivo próprio, sem raylib.h, porque windows.h conflita com a API do raylib.
+typedef struct MappedFile {
+    void *data;
+    size_t size;
+    bool writable;
+    intptr_t handle;    // Descritor (POSIX) ou HANDLE do arquivo (Windows).
+    intptr_t mapping;   // HANDLE do mapeamento (só no Windows).
+} MappedFile;
+
+// Mapeia um arquivo existente só para leitura.
+bool MapFileRead(MappedFile *file, const char *path);
+// Cria (ou trunca) o arquivo com o tamanho dado e o mapeia para escrita.
+bool MapFileCreate(MappedFile *file, const char *path, size_t size);
+// Grava as páginas alteradas (se for de escrita) e desfaz o mapeamento.
+bool UnmapFile(MappedFile *file);
+// Renomeia 'from' para 'to', substituindo 'to' de forma atômica: quem abrir
+// 'to' vê o arquivo antigo inteiro ou o novo inteiro, nunca um pela metade.
+bool ReplaceFileAtomically(const char *from, const char *to);
+// Corta o arquivo para 'size' bytes. Falha se ele não existir ou for menor.
+bool TruncateFile(const char *path, uint64_t size);
+
+#endif
@@ -0,0 +1,176 @@
+#include "observables.h"
+#include "threadpool.h"
+#include <stdlib.h>
+
+// Bolas por bloco da soma. Fixo, para a ordem das somas não depender das threads.
+#define SUM_BLOCK 4096
+
+static struct {
+    SystemTotals *blocks;
+    int blockCapacity;
+    DriftReference reference;
+    EnergyDrift drift;
+    double sampleImpulse;     // wallImpulse e simTime na amostra de pressão anterior.
+    double sampleTime;
+    double pressure;
+} observables = { 0 };
+
+typedef struct SumContext {
+    const Ball *balls;
+    int numBalls;
+} SumContext;
+
+//==================================================================================
+// Quatro acumuladores por grandeza, um por bola do grupo de quatro, para as
+// somas não formarem uma única cadeia de dependências. O laço é desenrolado à
+// mão para que cada acumulador seja uma variável própria; as bolas que sobram
+// do último grupo vão para o primeiro acumulador.
+//==================================================================================
+static void SumBlocks(void *context, int begin, int end, int worker) {
+    (void)worker;
+    const SumContext *sum = (const SumContext *)context;
+    for (int block = begin; block < end; block++) {
+        int first = block * SUM_BLOCK;
+        int last = (first + SUM_BLOCK < sum->numBalls) ? first + SUM_BLOCK : sum->numBalls;
+        const Ball *balls = sum->balls;
+        double e0 = 0.0, e1 = 0.0, e2 = 0.0, e3 = 0.0;
+        double px0 = 0.0, px1 = 0.0, px2 = 0.0, px3 = 0.0;
+        double py0 = 0.0, py1 = 0.0, py2 = 0.0, py3 = 0.0;
+        int i = first;
+        for (; i + 4 <= last; i += 4) {
+            double vx0 = balls[i].velocity.x, vy0 = balls[i].velocity.y, m0 = balls[i].mass;
+            double vx1 = balls[i + 1].velocity.x, vy1 = balls[i + 1].velocity.y, m1 = balls[i + 1].mass;
+            double vx2 = balls[i + 2].velocity.x, vy2 = balls[i + 2].velocity.y, m2 = balls[i + 2].mass;
+            double vx3 = balls[i + 3].velocity.x, vy3 = balls[i + 3].velocity.y, m3 = balls[i + 3].mass;
+            e0 += 0.5 * m0 * (vx0 * vx0 + vy0 * vy0);
+            e1 += 0.5 * m1 * (vx1 * vx1 + vy1 * vy1);
+            e2 += 0.5 * m2 * (vx2 * vx2 + vy2 * vy2);
+            e3 += 0.5 * m3 * (vx3 * vx3 + vy3 * vy3);
+            px0 += m0 * vx0;
+            px1 += m1 * vx1;
+            px2 += m2 * vx2;
+            px3 += m3 * vx3;
+            py0 += m0 * vy0;
+            py1 += m1 * vy1;
+            py2 += m2 * vy2;
+            py3 += m3 * vy3;
+        }
+        for (; i < last; i++) {
+            double vx = balls[i].velocity.x, vy = balls[i].velocity.y, m = balls[i].mass;
+            e0 += 0.5 * m * (vx * vx + vy * vy);
+            px0 += m * vx;
+            py0 += m * vy;
+        }
+        SystemTotals *totals = &observables.blocks[block];
+        totals->kineticEnergy = (e0 + e1) + (e2 + e3);
+        totals->momentumX = (px0 + px1) + (px2 + px3);
+        totals->momentumY = (py0 + py1) + (py2 + py3);
+    }
+}
+
+// Soma de Neumaier: 'compensation' guarda o que o arredondamento perdeu.
+static void CompensatedAdd(double *sum, double *compensation, double value) {
+    double t = *sum + value;
+    if ((*sum >= 0 ? *sum : -*sum) >= (value >= 0 ? value : -value)) {
+        *compensation += (*sum - t) + value;
+    } else {
+        *compensation += (value - t) + *sum;
+    }
+    *sum = t;
+}
+
+SystemTotals SumSystemTotals(const Ball balls[], int numBalls) {
+    SystemTotals totals = { 0 };
+    int blocks = (numBalls + SUM_BLOCK - 1) / SUM_BLOCK;
+    if (blocks == 0) return totals;
+    if (blocks > observables.blockCapacity) {
+        SystemTotals *grown = (SystemTotals *)realloc(observables.blocks, sizeof(SystemTotals) * blocks);
+        if (grown == NULL) return totals;
+        observables.blocks = grown;
+        observables.blockCapacity = blocks;
+    }
+
+    SumContext context = { balls, numBalls };
+    ParallelFor(blocks, 1, SumBlocks, &context);
+    SystemTotals compensation = { 0 };
+    for (int b = 0; b < blocks; b++) {
+        CompensatedAdd(&totals.kineticEnergy, &compensation.kineticEnergy, observables.blocks[b].kineticEnergy);
+        CompensatedAdd(&totals.momentumX, &compensation.momentumX, observables.blocks[b].momentumX);
+        CompensatedAdd(&totals.momentumY, &compensation.momentumY, observables.blocks[b].momentumY);
+    }
+    totals.kineticEnergy += compensation.kineticEnergy;
+    totals.momentumX += compensation.momentumX;
+    totals.momentumY += compensation.momentumY;
+    return totals;
+}
+
+// Deriva da soma completa em systemTotals em relação à referência.
+static void UpdateDrift(void) {
+    EnergyDrift *drift = &observables.drift;
+    drift->steps = simStep - observables.reference.step;
+    double reference = observables.reference.energy;
+    drift->relativeDrift = (reference != 0.0) ? (systemTotals.kineticEnergy - reference) / reference : 0.0;
+    drift->perMillionSteps = (drift->steps > 0) ? drift->relativeDrift * 1e6 / drift->steps : 0.0;
+}
+
+void SyncSystemTotals(const Ball balls[], int numBalls) {
+    systemTotals = SumSystemTotals(balls, numBalls);
+    observables.drift.trackedError = 0.0;
+    UpdateDrift();
+    observables.sampleImpulse = wallImpulse;
+    observables.sampleTime = simTime;
+    observables.pressure = 0.0;
+}
+
+void ResetDriftReference(void) {
+    observables.reference.energy = systemTotals.kineticEnergy;
+    observables.reference.step = simStep;
+    observables.drift = (EnergyDrift){ 0 };
+}
+
+DriftReference GetDriftReference(void) {
+    return observables.reference;
+}
+
+void SetDriftReference(DriftReference reference) {
+    observables.reference = reference;
+    UpdateDrift();
+}
+
+void CheckSystemTotals(const Ball balls[], int numBalls) {
+    double tracked = systemTotals.kineticEnergy;
+    systemTotals = SumSystemTotals(balls, numBalls);
+    double exact = systemTotals.kineticEnergy;
+    observables.drift.trackedError = (exact != 0.0) ? (tracked - exact) / exact : 0.0;
+    UpdateDrift();
+}
+
+EnergyDrift GetEnergyDrift(void) {
+    return observables.drift;
+}
+
+static Thermodynamics MakeThermodynamics(int numBalls, double pressure) {
+    Thermodynamics thermo = { 0 };
+    thermo.temperature = (numBalls > 0) ? systemTotals.kineticEnergy / numBalls : 0.0;
+    thermo.momentumX = systemTotals.momentumX;
+    thermo.momentumY = systemTotals.momentumY;
+    thermo.pressure = pressure;
+    double idealPressure = numBalls * thermo.temperature;
+    thermo.compressibility = (idealPressure > 0.0) ? thermo.pressure * WIDTH * HEIGHT / idealPressure : 0.0;
+    return thermo;
+}
+
+Thermodynamics SampleThermodynamics(int numBalls, double minWindow) {
+    double elapsed = simTime - observables.sampleTime;
+    if (elapsed > 0.0 && elapsed >= minWindow) {
+        observables.pressure = (wallImpulse - observables.sampleImpulse) / (2.0 * ((double)WIDTH + HEIGHT) * elapsed);
+        observables.sampleImpulse = wallImpulse;
+        observables.sampleTime = simTime;
+    }
+    return MakeThermodynamics(numBalls, observables.pressure);
+}
+
+Thermodynamics RunThermodynamics(int numBalls) {
+    double pressure = (simTime > 0.0) ? wallImpulse / (2.0 * ((double)WIDTH + HEIGHT) * simTime) : 0.0;
+    return MakeThermodynamics(numBalls, pressure);
+}
@@ -0,0 +1,64 @@
+#ifndef OBSERVABLES_H
+#define OBSERVABLES_H
+
+#include "sim.h"
+
+// --- Somas do sistema e deriva de energia ---
+// A soma completa roda em paralelo sobre blocos de tamanho fixo, cada um
+// com acumuladores double independentes, e os blocos são juntados em ordem
+// com soma compensada (Neumaier). O resultado não depende do número de
+// threads e o erro de arredondamento fica muito abaixo da deriva que se
+// quer medir, mesmo com milhões de bolas.
+typedef struct EnergyDrift {
+    double trackedError;      // (mantida - soma completa) / soma completa na última conferência.
+    double relativeDrift;     // (soma completa - referência) / referência.
+    double perMillionSteps;   // relativeDrift por 10^6 passos desde a referência.
+    long long steps;          // Passos desde a referência.
+} EnergyDrift;
+
+// Energia e passo a partir dos quais a deriva é medida. Vai junto nos
+// snapshots e nos quadros-chave da rebobinagem, para que a deriva continue
+// contando desde o início da execução depois de --resume, F9 ou rebobinar.
+typedef struct DriftReference {
+    double energy;
+    long long step;
+} DriftReference;
+
+// Observáveis termodinâmicos do gás 2D (k_B = 1), sem passar pelas bolas:
+// temperatura e momento vêm de systemTotals e a pressão, do impulso nas
+// paredes acumulado por CheckWallCollision, dividido pelo perímetro e pelo
+// tempo simulado desde a amostra anterior.
+typedef struct Thermodynamics {
+    double temperature;       // Energia cinética média por bola.
+    double momentumX;
+    double momentumY;
+    double pressure;          // Força por unidade de comprimento nas paredes.
+    double compressibility;   // P A / (N T): 1 no gás ideal.
+} Thermodynamics;
+
+SystemTotals SumSystemTotals(const Ball balls[], int numBalls);
+// Recalcula systemTotals do zero e a deriva em relação à referência atual;
+// chamada sempre que as bolas são trocadas por fora da simulação (InitBalls,
+// snapshot, rebobinagem).
+void SyncSystemTotals(const Ball balls[], int numBalls);
+// Toma a energia de systemTotals e o passo atual como nova referência da
+// deriva: só quando começa uma execução nova (InitBalls, arquivos sem
+// referência).
+void ResetDriftReference(void);
+DriftReference GetDriftReference(void);
+// Restaura a referência de um snapshot ou quadro-chave; chamada depois de
+// SyncSystemTotals.
+void SetDriftReference(DriftReference reference);
+// Conferência periódica: compara os totais mantidos pelas colisões com a
+// soma completa, atualiza a deriva e volta a sincronizá-los.
+void CheckSystemTotals(const Ball balls[], int numBalls);
+EnergyDrift GetEnergyDrift(void);
+// A pressão só é recalculada depois de pelo menos 'minWindow' segundos
+// simulados desde a amostra anterior (0 recalcula sempre que o tempo andou);
+// até lá, vale a anterior.
+Thermodynamics SampleThermodynamics(int numBalls, double minWindow);
+// Como SampleThermodynamics, mas com a pressão média desde o início da
+// execução (wallImpulse e simTime acumulados, que seguem nos checkpoints).
+Thermodynamics RunThermodynamics(int numBalls);
+
+#endif
@@ -0,0 +1,195 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "perfcounters.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *counterNames[PERF_COUNTER_COUNT] = {
+    "ciclos", "instrucoes", "l1d_misses", "llc_misses", "branch_misses"
+};
+
+const char *PerfCounterName(PerfCounter counter) {
+    return counterNames[counter];
+}
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Um grupo por thread contada: descritor de cada contador (-1 se o hardware
+// não o oferece) e sua posição na leitura agrupada, que só traz os
+// contadores efetivamente abertos. O grupo 0 é o da thread principal e
+// decide quais contadores existem; os das threads do ThreadPool abrem os
+// mesmos.
+typedef struct PerfGroup {
+    int fds[PERF_COUNTER_COUNT];
+    int slots[PERF_COUNTER_COUNT];
+    int openedCount;
+} PerfGroup;
+
+static const struct { uint32_t type; uint64_t config; } events[PERF_COUNTER_COUNT] = {
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16) },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+static PerfGroup groups[PERF_MAX_THREADS];
+static int groupCount = 0;
+// Alguma thread não conseguiu abrir seus contadores: as leituras falham em
+// vez de somar só parte das threads.
+static bool incomplete = false;
+
+static int OpenCounter(uint32_t type, uint64_t config, int leader) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = (leader == -1);
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+}
+
+static void CloseGroup(PerfGroup *group) {
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        if (group->fds[c] != -1) close(group->fds[c]);
+        group->fds[c] = -1;
+    }
+    group->openedCount = 0;
+}
+
+//==================================================================================
+// Abre um grupo para a thread atual, com ciclos como líder. 'wanted' diz quais
+// contadores abrir (NULL: todos os que existirem no processador). Retorna
+// false se o líder ou algum contador pedido não abrir.
+//==================================================================================
+static bool OpenGroup(PerfGroup *group, const PerfGroup *wanted) {
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) group->fds[c] = -1;
+    group->openedCount = 0;
+
+    int leader = OpenCounter(events[0].type, events[0].config, -1);
+    if (leader == -1) return false;
+    group->fds[0] = leader;
+    group->slots[0] = group->openedCount++;
+
+    for (int c = 1; c < PERF_COUNTER_COUNT; c++) {
+        if (wanted != NULL && wanted->fds[c] == -1) continue;
+        group->fds[c] = OpenCounter(events[c].type, events[c].config, leader);
+        if (group->fds[c] != -1) {
+            group->slots[c] = group->openedCount++;
+        } else if (wanted != NULL) {
+            CloseGroup(group);
+            return false;
+        } else {
+            fprintf(stderr, "perf_event_open: contador '%s' indisponível\n", counterNames[c]);
+        }
+    }
+
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+//==================================================================================
+// Abre o grupo de contadores da thread principal. Os que não existirem no
+// processador (comum em VMs) são ignorados.
+//==================================================================================
+bool PerfCountersInit(void) {
+    if (groupCount > 0) return true;
+
+    if (!OpenGroup(&groups[0], NULL)) {
+        fprintf(stderr, "perf_event_open: contadores de hardware indisponíveis (%s)\n", strerror(errno));
+        return false;
+    }
+    groupCount = 1;
+    incomplete = false;
+    return true;
+}
+
+//==================================================================================
+// Chamada pelas threads do ThreadPool ao começar, antes de o pool ser usado.
+// As threads abrem seus grupos ao mesmo tempo, então cada uma reserva o seu
+// índice com uma soma atômica.
+//==================================================================================
+void PerfCountersAttachThread(void) {
+    if (!PerfCountersEnabled()) return;
+    int index = __atomic_fetch_add(&groupCount, 1, __ATOMIC_ACQ_REL);
+    if (index >= PERF_MAX_THREADS || !OpenGroup(&groups[index], &groups[0])) {
+        if (index < PERF_MAX_THREADS) CloseGroup(&groups[index]);
+        __atomic_store_n(&incomplete, true, __ATOMIC_RELEASE);
+        fprintf(stderr, "perf_event_open: não foi possível contar uma thread auxiliar; contadores desligados\n");
+    }
+}
+
+void PerfCountersShutdown(void) {
+    int count = (groupCount < PERF_MAX_THREADS) ? groupCount : PERF_MAX_THREADS;
+    for (int g = 0; g < count; g++) CloseGroup(&groups[g]);
+    groupCount = 0;
+    incomplete = false;
+}
+
+bool PerfCountersEnabled(void) {
+    return __atomic_load_n(&groupCount, __ATOMIC_ACQUIRE) > 0;
+}
+
+bool PerfCounterAvailable(PerfCounter counter) {
+    return PerfCountersEnabled() && groups[0].fds[counter] != -1;
+}
+
+//==================================================================================
+// Lê cada grupo com uma única chamada de sistema e soma as threads.
+//==================================================================================
+bool PerfCountersRead(uint64_t values[PERF_COUNTER_COUNT]) {
+    uint64_t buffer[1 + PERF_COUNTER_COUNT];
+
+    memset(values, 0, sizeof(uint64_t) * PERF_COUNTER_COUNT);
+    if (!PerfCountersEnabled() || __atomic_load_n(&incomplete, __ATOMIC_ACQUIRE)) return false;
+
+    int count = (groupCount < PERF_MAX_THREADS) ? groupCount : PERF_MAX_THREADS;
+    for (int g = 0; g < count; g++) {
+        const PerfGroup *group = &groups[g];
+        ssize_t got = read(group->fds[0], buffer, sizeof(buffer));
+        if (got < (ssize_t)sizeof(uint64_t) || buffer[0] != (uint64_t)group->openedCount) return false;
+        if (got < (ssize_t)(sizeof(uint64_t) * (1 + group->openedCount))) return false;
+
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+            if (group->fds[c] != -1) values[c] += buffer[1 + group->slots[c]];
+        }
+    }
+    return true;
+}
+#else
+bool PerfCountersInit(void) {
+    fprintf(stderr, "Contadores de hardware só estão disponíveis no Linux\n");
+    return false;
+}
+
+void PerfCountersAttachThread(void) {
+}
+
+void PerfCountersShutdown(void) {
+}
+
+bool PerfCountersEnabled(void) {
+    return false;
+}
+
+bool PerfCounterAvailable(PerfCounter counter) {
+    (void)counter;
+    return false;
+}
+
+bool PerfCountersRead(uint64_t values[PERF_COUNTER_COUNT]) {
+    memset(values, 0, sizeof(uint64_t) * PERF_COUNTER_COUNT);
+    return false;
+}
+#endif
@@ -0,0 +1,39 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// --- Contadores de hardware ---
+// Camada opcional, só para Linux, sobre perf_event_open: abre um grupo de
+// contadores para a thread principal e um para cada thread do ThreadPool, e
+// as leituras somam todas elas, para que as fases paralelas (soma da energia,
+// mapa de calor, quadros sem janela) sejam contadas por inteiro.
+// Em outras plataformas (ou sem permissão) PerfCountersInit retorna false e
+// as leituras falham. Contadores que o processador não oferece ficam fora do
+// grupo e são reportados por PerfCounterAvailable.
+
+// Threads contadas no máximo: a principal e as do ThreadPool.
+#define PERF_MAX_THREADS 32
+
+typedef enum PerfCounter {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_COUNTER_COUNT
+} PerfCounter;
+
+bool PerfCountersInit(void);
+// Abre os contadores da thread que chama; sem efeito se PerfCountersInit não
+// tiver sido chamada antes (por isso ela vem antes do primeiro ParallelFor).
+void PerfCountersAttachThread(void);
+void PerfCountersShutdown(void);
+bool PerfCountersEnabled(void);
+bool PerfCounterAvailable(PerfCounter counter);
+// Retorna false (com 'values' zerado) se a leitura falhar.
+bool PerfCountersRead(uint64_t values[PERF_COUNTER_COUNT]);
+const char *PerfCounterName(PerfCounter counter);
+
+#endif
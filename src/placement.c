@@ -0,0 +1,315 @@
+#include "placement.h"
+#include "rng.h"
+#include "threadpool.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Células por bola acima das quais a célula cresce: mundos enormes e quase
+// vazios não precisam de uma grade proporcional à área.
+#define MAX_CELLS_PER_BALL 4
+
+//==================================================================================
+// O lado da célula começa no maior diâmetro e dobra até o número de células
+// ficar proporcional ao de bolas.
+//==================================================================================
+bool PlacementGridInit(PlacementGrid *grid, int numBalls) {
+    memset(grid, 0, sizeof(*grid));
+    float cellSize = 2.0f * MAX_BALL_RADIUS;
+    long long maxCells = (long long)MAX_CELLS_PER_BALL * (numBalls > 0 ? numBalls : 1) + 1024;
+    int cols, rows;
+    for (;;) {
+        cols = (int)(WIDTH / cellSize) + 1;
+        rows = (int)(HEIGHT / cellSize) + 1;
+        if ((long long)cols * rows <= maxCells) break;
+        cellSize *= 2.0f;
+    }
+
+    grid->head = (int *)malloc(sizeof(int) * (size_t)cols * rows);
+    grid->next = (int *)malloc(sizeof(int) * (size_t)(numBalls > 0 ? numBalls : 1));
+    if (grid->head == NULL || grid->next == NULL) {
+        PlacementGridFree(grid);
+        return false;
+    }
+    memset(grid->head, 0xFF, sizeof(int) * (size_t)cols * rows);
+    grid->cellSize = cellSize;
+    grid->cols = cols;
+    grid->rows = rows;
+    return true;
+}
+
+void PlacementGridFree(PlacementGrid *grid) {
+    free(grid->head);
+    free(grid->next);
+    memset(grid, 0, sizeof(*grid));
+}
+
+static int CellColumn(const PlacementGrid *grid, float x) {
+    int col = (int)(x / grid->cellSize);
+    return (col < 0) ? 0 : (col >= grid->cols) ? grid->cols - 1 : col;
+}
+
+static int CellRow(const PlacementGrid *grid, float y) {
+    int row = (int)(y / grid->cellSize);
+    return (row < 0) ? 0 : (row >= grid->rows) ? grid->rows - 1 : row;
+}
+
+bool PlacementGridFits(const PlacementGrid *grid, const Ball balls[], Vector2 position, int radius) {
+    int col = CellColumn(grid, position.x);
+    int row = CellRow(grid, position.y);
+    int minCol = (col > 0) ? col - 1 : 0;
+    int maxCol = (col < grid->cols - 1) ? col + 1 : col;
+    int minRow = (row > 0) ? row - 1 : 0;
+    int maxRow = (row < grid->rows - 1) ? row + 1 : row;
+
+    for (int r = minRow; r <= maxRow; r++) {
+        for (int c = minCol; c <= maxCol; c++) {
+            for (int j = grid->head[r * grid->cols + c]; j >= 0; j = grid->next[j]) {
+                float dx = position.x - balls[j].position.x;
+                float dy = position.y - balls[j].position.y;
+                float minDist = (float)(radius + balls[j].radius);
+                if (dx * dx + dy * dy < minDist * minDist) return false;
+            }
+        }
+    }
+    return true;
+}
+
+void PlacementGridInsert(PlacementGrid *grid, const Ball balls[], int index) {
+    int cell = CellRow(grid, balls[index].position.y) * grid->cols + CellColumn(grid, balls[index].position.x);
+    grid->next[index] = grid->head[cell];
+    grid->head[cell] = index;
+}
+
+const char *InitLayoutName(InitLayout layout) {
+    switch (layout) {
+        case LAYOUT_HEX: return "hex";
+        case LAYOUT_SQUARE: return "quadrada";
+        case LAYOUT_RSA: return "rsa";
+        default: return "aleatorio";
+    }
+}
+
+bool ParseInitLayout(const char *name, InitLayout *layout) {
+    for (int i = 0; i < LAYOUT_COUNT; i++) {
+        if (strcmp(name, InitLayoutName((InitLayout)i)) == 0) {
+            *layout = (InitLayout)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+//==================================================================================
+// O raio e as posições tentadas de cada dardo vêm do gerador da bola 'i'
+// (o dardo, não a posição final no vetor), então não dependem de quantos
+// dardos anteriores falharam nem de quantas tentativas eles gastaram. A
+// aceitação em si é sequencial: cada dardo depende dos aceitos antes dele.
+//==================================================================================
+int PlaceBallsRandom(Ball balls[], int numBalls, int attempts, float maxFraction, int maxFailures, uint64_t generation) {
+    PlacementGrid grid;
+    if (!PlacementGridInit(&grid, numBalls)) {
+        fprintf(stderr, "Memória insuficiente para posicionar %d bolas\n", numBalls);
+        return 0;
+    }
+
+    double maxArea = (double)maxFraction * WIDTH * HEIGHT;
+    double area = 0.0;
+    int placed = 0;
+    int failures = 0;
+    for (int i = 0; i < numBalls && area < maxArea && (maxFailures <= 0 || failures < maxFailures); i++) {
+        Ball *ball = &balls[placed];
+        Rng rng;
+        RngInit(&rng, simSeed, RNG_STREAM_PLACEMENT, (uint32_t)i, generation);
+        ball->radius = RngInt(&rng, MIN_BALL_RADIUS, MAX_BALL_RADIUS);
+        ball->mass = (float)ball->radius / 2.0f;
+
+        bool positionFound = false;
+        for (int attempt = 0; !positionFound && attempt < attempts; attempt++) {
+            ball->position = (Vector2){
+                (float)RngInt(&rng, ball->radius, WIDTH - ball->radius),
+                (float)RngInt(&rng, ball->radius, HEIGHT - ball->radius)
+            };
+            positionFound = PlacementGridFits(&grid, balls, ball->position, ball->radius);
+        }
+
+        if (positionFound) {
+            PlacementGridInsert(&grid, balls, placed);
+            area += PI * ball->radius * ball->radius;
+            placed++;
+            failures = 0;
+        } else {
+            failures++;
+        }
+    }
+    PlacementGridFree(&grid);
+    return placed;
+}
+
+//==================================================================================
+// Fração de área de uma bola por sítio: na rede quadrada de lado a,
+// pi r² / a²; na hexagonal, pi r² / (a² sqrt(3)/2). O espaçamento mínimo é
+// um diâmetro com uma folga relativa de 1e-4, para o arredondamento das
+// posições não criar sobreposições.
+//==================================================================================
+int PlaceBallsLattice(Ball balls[], int numBalls, InitLayout layout, float packing) {
+    int radius = (MIN_BALL_RADIUS + MAX_BALL_RADIUS) / 2;
+    float cellArea = (layout == LAYOUT_HEX) ? sqrtf(3.0f) / 2.0f : 1.0f;
+    float minSpacing = 2.0f * radius * 1.0001f;
+    float spacing = (packing > 0.0f) ? sqrtf(PI * radius * radius / (packing * cellArea)) : minSpacing;
+    if (spacing < minSpacing) spacing = minSpacing;
+    float rowSpacing = spacing * cellArea;
+
+    int placed = 0;
+    for (int row = 0; placed < numBalls; row++) {
+        float y = spacing / 2.0f + row * rowSpacing;
+        if (y > HEIGHT - radius) break;
+        float x0 = spacing / 2.0f + ((layout == LAYOUT_HEX && row % 2 == 1) ? spacing / 2.0f : 0.0f);
+        for (int col = 0; placed < numBalls; col++) {
+            float x = x0 + col * spacing;
+            if (x > WIDTH - radius) break;
+            balls[placed].radius = radius;
+            balls[placed].mass = (float)radius / 2.0f;
+            balls[placed].position = (Vector2){ x, y };
+            placed++;
+        }
+    }
+    return placed;
+}
+
+float AreaFraction(const Ball balls[], int numBalls) {
+    double area = 0.0;
+    for (int i = 0; i < numBalls; i++) area += PI * balls[i].radius * balls[i].radius;
+    return (float)(area / ((double)WIDTH * HEIGHT));
+}
+
+// Bolas por bloco das somas de DrawThermalVelocities. Os blocos não
+// dependem do número de threads, então as somas (e as velocidades) também não.
+#define THERMAL_BLOCK 4096
+#define APPEARANCE_MIN_PER_WORKER 4096
+
+typedef struct ThermalContext {
+    Ball *balls;
+    int numBalls;
+    float temperature;
+    uint64_t generation;
+    double *sums;         // Por bloco: momento x, momento y, massa, energia.
+    float centerX;
+    float centerY;
+    float scale;
+} ThermalContext;
+
+static void DrawGaussianBlocks(void *context, int begin, int end, int worker) {
+    (void)worker;
+    ThermalContext *thermal = (ThermalContext *)context;
+    for (int block = begin; block < end; block++) {
+        int last = (block + 1) * THERMAL_BLOCK;
+        if (last > thermal->numBalls) last = thermal->numBalls;
+        double momentumX = 0.0, momentumY = 0.0, mass = 0.0;
+        for (int i = block * THERMAL_BLOCK; i < last; i++) {
+            Ball *ball = &thermal->balls[i];
+            Rng rng;
+            RngInit(&rng, simSeed, RNG_STREAM_THERMAL, (uint32_t)i, thermal->generation);
+            double magnitude = sqrt(-2.0 * log(RngUnit(&rng)));
+            double angle = 2.0 * PI * RngUnit(&rng);
+            double sigma = sqrt(thermal->temperature / ball->mass);
+            ball->velocity = (Vector2){ (float)(sigma * magnitude * cos(angle)), (float)(sigma * magnitude * sin(angle)) };
+            momentumX += ball->mass * ball->velocity.x;
+            momentumY += ball->mass * ball->velocity.y;
+            mass += ball->mass;
+        }
+        thermal->sums[block * 4 + 0] = momentumX;
+        thermal->sums[block * 4 + 1] = momentumY;
+        thermal->sums[block * 4 + 2] = mass;
+    }
+}
+
+static void RemoveDriftBlocks(void *context, int begin, int end, int worker) {
+    (void)worker;
+    ThermalContext *thermal = (ThermalContext *)context;
+    for (int block = begin; block < end; block++) {
+        int last = (block + 1) * THERMAL_BLOCK;
+        if (last > thermal->numBalls) last = thermal->numBalls;
+        double energy = 0.0;
+        for (int i = block * THERMAL_BLOCK; i < last; i++) {
+            Ball *ball = &thermal->balls[i];
+            ball->velocity.x -= thermal->centerX;
+            ball->velocity.y -= thermal->centerY;
+            energy += 0.5 * ball->mass * (ball->velocity.x * ball->velocity.x + ball->velocity.y * ball->velocity.y);
+        }
+        thermal->sums[block * 4 + 3] = energy;
+    }
+}
+
+static void ScaleBlocks(void *context, int begin, int end, int worker) {
+    (void)worker;
+    ThermalContext *thermal = (ThermalContext *)context;
+    int first = begin * THERMAL_BLOCK;
+    int last = end * THERMAL_BLOCK;
+    if (last > thermal->numBalls) last = thermal->numBalls;
+    for (int i = first; i < last; i++) {
+        thermal->balls[i].velocity.x *= thermal->scale;
+        thermal->balls[i].velocity.y *= thermal->scale;
+    }
+}
+
+//==================================================================================
+// Componentes gaussianas com variância T/m (Box-Muller), seguidas da remoção
+// da velocidade do centro de massa e de um reescalonamento para a energia
+// cinética total dar exatamente numBalls * T. Cada passada roda em paralelo
+// por blocos fixos, e as somas dos blocos são juntadas em ordem.
+//==================================================================================
+void DrawThermalVelocities(Ball balls[], int numBalls, float temperature, uint64_t generation) {
+    int blocks = (numBalls + THERMAL_BLOCK - 1) / THERMAL_BLOCK;
+    if (blocks == 0) return;
+    ThermalContext thermal = { balls, numBalls, temperature, generation, NULL, 0.0f, 0.0f, 1.0f };
+    thermal.sums = (double *)malloc(sizeof(double) * 4 * blocks);
+    if (thermal.sums == NULL) return;
+
+    ParallelFor(blocks, 1, DrawGaussianBlocks, &thermal);
+    double momentumX = 0.0, momentumY = 0.0, totalMass = 0.0;
+    for (int b = 0; b < blocks; b++) {
+        momentumX += thermal.sums[b * 4 + 0];
+        momentumY += thermal.sums[b * 4 + 1];
+        totalMass += thermal.sums[b * 4 + 2];
+    }
+    if (totalMass > 0.0) {
+        thermal.centerX = (float)(momentumX / totalMass);
+        thermal.centerY = (float)(momentumY / totalMass);
+        ParallelFor(blocks, 1, RemoveDriftBlocks, &thermal);
+        double energy = 0.0;
+        for (int b = 0; b < blocks; b++) energy += thermal.sums[b * 4 + 3];
+        if (energy > 0.0) {
+            thermal.scale = (float)sqrt((double)numBalls * temperature / energy);
+            ParallelFor(blocks, 1, ScaleBlocks, &thermal);
+        }
+    }
+    free(thermal.sums);
+}
+
+typedef struct AppearanceContext {
+    Ball *balls;
+    uint64_t generation;
+} AppearanceContext;
+
+static void DrawAppearanceRange(void *context, int begin, int end, int worker) {
+    (void)worker;
+    const AppearanceContext *appearance = (const AppearanceContext *)context;
+    for (int i = begin; i < end; i++) {
+        Ball *ball = &appearance->balls[i];
+        Rng rng;
+        RngInit(&rng, simSeed, RNG_STREAM_APPEARANCE, (uint32_t)i, appearance->generation);
+        ball->velocity = (Vector2){
+            (float)RngInt(&rng, (int)-VELOCITY_SCALE, (int)VELOCITY_SCALE),
+            (float)RngInt(&rng, (int)-VELOCITY_SCALE, (int)VELOCITY_SCALE)
+        };
+        ball->color = (Color){ (unsigned char)RngInt(&rng, 100, 255), (unsigned char)RngInt(&rng, 100, 255),
+                               (unsigned char)RngInt(&rng, 100, 255), 255 };
+    }
+}
+
+void DrawAppearance(Ball balls[], int numBalls, uint64_t generation) {
+    AppearanceContext appearance = { balls, generation };
+    ParallelFor(numBalls, APPEARANCE_MIN_PER_WORKER, DrawAppearanceRange, &appearance);
+}
@@ -0,0 +1,72 @@
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include <stdint.h>
+#include "sim.h"
+
+// --- Grade de posicionamento inicial ---
+// Grade de fundo para o lançamento de dardos do InitBalls: cada bola
+// aceita entra numa lista encadeada da sua célula, e uma posição nova só é
+// comparada com as bolas das células vizinhas. O lado da célula é pelo
+// menos o maior diâmetro, então as 3x3 células em volta bastam.
+typedef struct PlacementGrid {
+    float cellSize;
+    int cols;
+    int rows;
+    int *head;    // Primeira bola de cada célula (-1: vazia).
+    int *next;    // Próxima bola na mesma célula.
+} PlacementGrid;
+
+// --- Configurações iniciais ---
+// LAYOUT_RANDOM é o lançamento de dardos de sempre (raios sorteados, até
+// 100 tentativas por bola). As redes usam bolas todas do raio médio, com o
+// espaçamento que dá a fração de área 'packing' (limitada à da rede
+// compacta, em que as vizinhas quase se tocam), preenchidas a partir do
+// canto superior esquerdo. LAYOUT_RSA (adsorção sequencial aleatória) lança
+// dardos com muito mais tentativas até a fração de área 'packing' ou até
+// emperrar. Com temperature > 0 as velocidades saem de uma gaussiana, sem
+// movimento do centro de massa e com energia cinética média por bola igual
+// a 'temperature'; senão, cada componente é uniforme em ±VELOCITY_SCALE.
+// Os sorteios usam o gerador de rng.h, com a semente da simulação e o
+// número da inicialização ('generation'), então se repetem com a mesma
+// semente independentemente do número de threads.
+typedef enum InitLayout {
+    LAYOUT_RANDOM,
+    LAYOUT_HEX,
+    LAYOUT_SQUARE,
+    LAYOUT_RSA,
+    LAYOUT_COUNT
+} InitLayout;
+
+typedef struct InitOptions {
+    InitLayout layout;
+    float packing;        // Fração de área alvo das redes e do RSA.
+    float temperature;    // Energia cinética média por bola; 0 para o sorteio uniforme.
+} InitOptions;
+
+extern InitOptions initOptions;   // Definida em main.c (--layout, --packing, --temperature).
+
+const char *InitLayoutName(InitLayout layout);
+// Aceita os nomes de InitLayoutName. Retorna false para um nome desconhecido.
+bool ParseInitLayout(const char *name, InitLayout *layout);
+
+// Lança dardos até 'attempts' vezes por bola e para ao atingir a fração de
+// área 'maxFraction' ou depois de 'maxFailures' bolas seguidas sem lugar
+// (0: nunca). As bolas aceitas ficam no começo do vetor, só com raio, massa
+// e posição. Retorna quantas.
+int PlaceBallsRandom(Ball balls[], int numBalls, int attempts, float maxFraction, int maxFailures, uint64_t generation);
+// Posiciona até numBalls bolas na rede hexagonal ou quadrada. Retorna quantas couberam.
+int PlaceBallsLattice(Ball balls[], int numBalls, InitLayout layout, float packing);
+// Fração da área do mundo ocupada pelas bolas.
+float AreaFraction(const Ball balls[], int numBalls);
+// Cor e velocidade uniforme de cada bola, em paralelo.
+void DrawAppearance(Ball balls[], int numBalls, uint64_t generation);
+void DrawThermalVelocities(Ball balls[], int numBalls, float temperature, uint64_t generation);
+
+bool PlacementGridInit(PlacementGrid *grid, int numBalls);
+void PlacementGridFree(PlacementGrid *grid);
+// Se uma bola de raio 'radius' em 'position' não sobrepõe nenhuma já inserida.
+bool PlacementGridFits(const PlacementGrid *grid, const Ball balls[], Vector2 position, int radius);
+void PlacementGridInsert(PlacementGrid *grid, const Ball balls[], int index);
+
+#endif
@@ -0,0 +1,148 @@
+#include "raylib.h"
+#include "profiler.h"
+#include "timer.h"
+#include "trace.h"
+
+static const char *phaseNames[PHASE_COUNT] = { "Integração", "Broadphase", "Narrowphase", "Energia", "Desenho" };
+static const char *phaseKeys[PHASE_COUNT] = { "integracao", "broadphase", "narrowphase", "energia", "desenho" };
+static const Color phaseColors[PHASE_COUNT] = { SKYBLUE, GOLD, ORANGE, LIME, PURPLE };
+
+// Estado do quadro atual: início de cada fase aberta e tempo acumulado
+// (uma fase pode ser aberta mais de uma vez no mesmo quadro).
+static uint64_t phaseStart[PHASE_COUNT];
+static uint64_t phaseAccumulated[PHASE_COUNT];
+static uint64_t frameStart = 0;
+
+// Totais desde o início da execução, usados pelos relatórios em CSV.
+static uint64_t phaseTotalNs[PHASE_COUNT];
+static uint64_t phaseCounterStart[PHASE_COUNT][PERF_COUNTER_COUNT];
+static bool phaseCounterStartValid[PHASE_COUNT];
+static uint64_t phaseCounterTotal[PHASE_COUNT][PERF_COUNTER_COUNT];
+
+// Histórico circular, em milissegundos, dos últimos PROFILER_HISTORY quadros.
+static float phaseHistory[PHASE_COUNT][PROFILER_HISTORY];
+static float frameHistory[PROFILER_HISTORY];
+static int historyIndex = 0;
+static int historyCount = 0;
+
+//==================================================================================
+// Abre/fecha uma fase. A leitura dos contadores fica fora do intervalo
+// cronometrado para que o custo da chamada de sistema não entre no tempo.
+// Se a leitura do início ou a do fim falhar, a fase não soma contadores
+// (a diferença com uma leitura zerada daria lixo).
+//==================================================================================
+void ProfilerBegin(ProfilerPhase phase) {
+    if (PerfCountersEnabled()) phaseCounterStartValid[phase] = PerfCountersRead(phaseCounterStart[phase]);
+    phaseStart[phase] = TimerNowNs();
+}
+
+void ProfilerEnd(ProfilerPhase phase) {
+    uint64_t now = TimerNowNs();
+    phaseAccumulated[phase] += now - phaseStart[phase];
+    phaseTotalNs[phase] += now - phaseStart[phase];
+
+    if (PerfCountersEnabled() && phaseCounterStartValid[phase]) {
+        uint64_t values[PERF_COUNTER_COUNT];
+        if (PerfCountersRead(values)) {
+            for (int c = 0; c < PERF_COUNTER_COUNT; c++) phaseCounterTotal[phase][c] += values[c] - phaseCounterStart[phase][c];
+        }
+    }
+    if (TraceIsCapturing()) TraceRecordSpan(phaseNames[phase], TRACE_MAIN_THREAD, phaseStart[phase], now);
+}
+
+//==================================================================================
+// Fecha o quadro atual: grava no histórico o tempo de cada fase e o tempo
+// total desde o quadro anterior (que inclui a espera por vsync/FPS alvo).
+// Com um trace em andamento, o quadro vira o span que contém as fases.
+//==================================================================================
+void ProfilerFrame(void) {
+    uint64_t now = TimerNowNs();
+    if (frameStart != 0 && TraceIsCapturing()) TraceRecordSpan("Quadro", TRACE_MAIN_THREAD, frameStart, now);
+
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        phaseHistory[p][historyIndex] = (float)(phaseAccumulated[p] / 1e6);
+        phaseAccumulated[p] = 0;
+    }
+    frameHistory[historyIndex] = (frameStart != 0) ? (float)((now - frameStart) / 1e6) : 0.0f;
+    frameStart = now;
+
+    historyIndex = (historyIndex + 1) % PROFILER_HISTORY;
+    if (historyCount < PROFILER_HISTORY) historyCount++;
+}
+
+double ProfilerAverageMs(ProfilerPhase phase) {
+    if (historyCount == 0) return 0.0;
+    double sum = 0.0;
+    for (int i = 0; i < historyCount; i++) sum += phaseHistory[phase][i];
+    return sum / historyCount;
+}
+
+double ProfilerAverageFrameMs(void) {
+    if (historyCount == 0) return 0.0;
+    double sum = 0.0;
+    for (int i = 0; i < historyCount; i++) sum += frameHistory[i];
+    return sum / historyCount;
+}
+
+const char *ProfilerPhaseName(ProfilerPhase phase) {
+    return phaseNames[phase];
+}
+
+// Nome sem acentos da fase, usado nos cabeçalhos do CSV.
+const char *ProfilerPhaseKey(ProfilerPhase phase) {
+    return phaseKeys[phase];
+}
+
+uint64_t ProfilerTotalNs(ProfilerPhase phase) {
+    return phaseTotalNs[phase];
+}
+
+uint64_t ProfilerCounterTotal(ProfilerPhase phase, PerfCounter counter) {
+    return phaseCounterTotal[phase][counter];
+}
+
+//==================================================================================
+// Desenha a tabela de médias móveis por fase e, abaixo dela, o gráfico do
+// tempo de quadro com as fases empilhadas em cores.
+//==================================================================================
+void DrawProfilerOverlay(int x, int y) {
+    const int graphWidth = PROFILER_HISTORY * 2;
+    const int graphHeight = 60;
+    double frameMs = ProfilerAverageFrameMs();
+
+    DrawText(TextFormat("Quadro: %.2f ms (média de %d)", frameMs, historyCount), x, y, 10, RAYWHITE);
+    for (int p = 0; p < PHASE_COUNT; p++) {
+        double ms = ProfilerAverageMs((ProfilerPhase)p);
+        double percent = (frameMs > 0.0) ? 100.0 * ms / frameMs : 0.0;
+        DrawRectangle(x, y + 15 + p * 12, 8, 8, phaseColors[p]);
+        DrawText(TextFormat("%s: %.3f ms (%.1f%%)", phaseNames[p], ms, percent), x + 12, y + 14 + p * 12, 10, RAYWHITE);
+    }
+
+    // Escala: o maior tempo de quadro do histórico, com uma linha de referência em 60 FPS.
+    int graphY = y + 20 + PHASE_COUNT * 12;
+    float maxMs = 1000.0f / 60.0f;
+    for (int i = 0; i < historyCount; i++) {
+        if (frameHistory[i] > maxMs) maxMs = frameHistory[i];
+    }
+    float scale = graphHeight / maxMs;
+
+    DrawRectangle(x, graphY, graphWidth, graphHeight, (Color){ 0, 0, 0, 160 });
+    for (int i = 0; i < historyCount; i++) {
+        // Mais antigo à esquerda, mais recente à direita.
+        int slot = (historyIndex - historyCount + i + PROFILER_HISTORY) % PROFILER_HISTORY;
+        int barX = x + (PROFILER_HISTORY - historyCount + i) * 2;
+        int frameHeight = (int)(frameHistory[slot] * scale);
+        DrawRectangle(barX, graphY + graphHeight - frameHeight, 2, frameHeight, DARKGRAY);
+
+        int stacked = 0;
+        for (int p = 0; p < PHASE_COUNT; p++) {
+            int h = (int)(phaseHistory[p][slot] * scale);
+            if (h <= 0) continue;
+            stacked += h;
+            DrawRectangle(barX, graphY + graphHeight - stacked, 2, h, phaseColors[p]);
+        }
+    }
+    int refY = graphY + graphHeight - (int)(1000.0f / 60.0f * scale);
+    DrawLine(x, refY, x + graphWidth, refY, RED);
+    DrawRectangleLines(x, graphY, graphWidth, graphHeight, GRAY);
+}
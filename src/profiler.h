@@ -0,0 +1,51 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include "perfcounters.h"
+
+// --- Profiler por fase ---
+// Mede o tempo de cada fase do quadro com o relógio de alta resolução e
+// mantém um histórico curto para médias móveis e o gráfico do HUD. Se os
+// contadores de hardware estiverem ativos, também os amostra em cada fase.
+// Compile com -DPROFILER_ENABLED=0 para que as macros não gerem código algum.
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+// Número de quadros usados nas médias móveis e no gráfico de tempo de quadro.
+#define PROFILER_HISTORY 120
+
+typedef enum ProfilerPhase {
+    PHASE_INTEGRATION,
+    PHASE_BROADPHASE,
+    PHASE_NARROWPHASE,
+    PHASE_ENERGY,
+    PHASE_DRAW,
+    PHASE_COUNT
+} ProfilerPhase;
+
+#if PROFILER_ENABLED
+#define PROFILE_BEGIN(phase) ProfilerBegin(phase)
+#define PROFILE_END(phase) ProfilerEnd(phase)
+#define PROFILE_FRAME() ProfilerFrame()
+#define PROFILE_DRAW_OVERLAY(x, y) DrawProfilerOverlay(x, y)
+#else
+#define PROFILE_BEGIN(phase) ((void)0)
+#define PROFILE_END(phase) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#define PROFILE_DRAW_OVERLAY(x, y) ((void)0)
+#endif
+
+void ProfilerBegin(ProfilerPhase phase);
+void ProfilerEnd(ProfilerPhase phase);
+void ProfilerFrame(void);
+double ProfilerAverageMs(ProfilerPhase phase);
+double ProfilerAverageFrameMs(void);
+const char *ProfilerPhaseName(ProfilerPhase phase);
+const char *ProfilerPhaseKey(ProfilerPhase phase);
+uint64_t ProfilerTotalNs(ProfilerPhase phase);
+uint64_t ProfilerCounterTotal(ProfilerPhase phase, PerfCounter counter);
+void DrawProfilerOverlay(int x, int y);
+
+#endif
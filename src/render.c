@@ -0,0 +1,408 @@
+#include "render.h"
+#include "heatmap.h"
+#include "rlgl.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Lado da textura do círculo; o disco ocupa até 1 pixel da borda, para o
+// anti-aliasing não ser cortado.
+#define SPRITE_SIZE 64
+#define SPRITE_RADIUS (SPRITE_SIZE / 2 - 1)
+
+// Quads por lote. Bem abaixo do limite do lote padrão do rlgl, que é
+// esvaziado antes de cada lote se não houver espaço.
+#define SPRITES_PER_BATCH 2048
+
+// Círculos de DrawCircleV: raylib usa 36 segmentos, três vértices cada.
+#define CIRCLE_SEGMENTS 36
+
+// Níveis de detalhe do modo LOD: segmentos por círculo, do menor ao maior.
+// O nível é o menor cujo erro (distância entre a corda e o arco) fica abaixo
+// de LOD_TOLERANCE pixels.
+#define LOD_LEVEL_COUNT 8
+#define LOD_MAX_SEGMENTS 64
+#define LOD_TOLERANCE 0.25f
+static const int lodSegments[LOD_LEVEL_COUNT] = { 6, 8, 12, 16, 24, 32, 48, 64 };
+static Vector2 lodCircle[LOD_LEVEL_COUNT][LOD_MAX_SEGMENTS + 1];   // Pontos do círculo unitário.
+
+static Texture2D circleTexture = { 0 };
+static long long vertexCount = 0;
+
+// Atlas dos rótulos de massa: linhas de altura fixa preenchidas da esquerda
+// para a direita, com uma tabela de hash (endereçamento aberto) da massa
+// para o retângulo do rótulo.
+#define LABEL_ATLAS_SIZE 512
+#define LABEL_FONT_SIZE 10
+#define LABEL_ROW_HEIGHT 12
+#define LABEL_TABLE_SIZE 2048          // Potência de 2; no máximo metade ocupada.
+#define LABEL_MIN_RADIUS 10.0f         // Bolas com raio menor que isso na tela ficam sem rótulo.
+#define LABEL_MAX_BALLS 2000           // Acima disso, os rótulos viram ruído.
+
+typedef struct MassLabel {
+    float mass;
+    Rectangle source;                  // Retângulo no atlas.
+} MassLabel;
+
+static struct {
+    RenderTexture2D atlas;
+    MassLabel labels[LABEL_TABLE_SIZE / 2];
+    int labelCount;
+    int table[LABEL_TABLE_SIZE];       // Índice em labels + 1; 0 é vazio.
+    int penX;
+    int penY;
+    int *ballLabel;                    // Rótulo de cada bola no quadro atual, ou -1.
+    int ballCapacity;
+} labelCache = { 0 };
+
+// Valores mostrados no HUD fixo; a textura é refeita quando algum muda.
+typedef struct StaticHudKey {
+    int numBalls;
+    RenderMode renderMode;
+    HeatmapQuantity heatmapQuantity;
+    int screenWidth;
+    int screenHeight;
+} StaticHudKey;
+
+static RenderTexture2D staticHud = { 0 };
+static StaticHudKey staticHudKey = { 0 };
+
+//==================================================================================
+// Gera a textura do círculo: branco, com alfa dado pela cobertura de cada
+// pixel pelo disco (uma rampa de 1 pixel na borda), para ser tingida pela
+// cor de cada vértice. Mipmaps mantêm bolas pequenas suaves.
+//==================================================================================
+void RenderInit(void) {
+    unsigned char *pixels = (unsigned char *)malloc(SPRITE_SIZE * SPRITE_SIZE * 4);
+    if (pixels == NULL) return;
+
+    const float center = SPRITE_SIZE / 2.0f;
+    for (int y = 0; y < SPRITE_SIZE; y++) {
+        for (int x = 0; x < SPRITE_SIZE; x++) {
+            float dx = x + 0.5f - center;
+            float dy = y + 0.5f - center;
+            float coverage = SPRITE_RADIUS + 0.5f - sqrtf(dx * dx + dy * dy);
+            if (coverage < 0.0f) coverage = 0.0f;
+            if (coverage > 1.0f) coverage = 1.0f;
+            unsigned char *pixel = pixels + 4 * (y * SPRITE_SIZE + x);
+            pixel[0] = pixel[1] = pixel[2] = 255;
+            pixel[3] = (unsigned char)(coverage * 255.0f + 0.5f);
+        }
+    }
+
+    Image image = { pixels, SPRITE_SIZE, SPRITE_SIZE, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+    circleTexture = LoadTextureFromImage(image);
+    GenTextureMipmaps(&circleTexture);
+    SetTextureFilter(circleTexture, TEXTURE_FILTER_TRILINEAR);
+    free(pixels);
+
+    for (int level = 0; level < LOD_LEVEL_COUNT; level++) {
+        for (int s = 0; s <= lodSegments[level]; s++) {
+            float angle = 2.0f * PI * s / lodSegments[level];
+            lodCircle[level][s] = (Vector2){ cosf(angle), sinf(angle) };
+        }
+    }
+}
+
+void RenderShutdown(void) {
+    if (circleTexture.id != 0) UnloadTexture(circleTexture);
+    circleTexture = (Texture2D){ 0 };
+    if (labelCache.atlas.id != 0) UnloadRenderTexture(labelCache.atlas);
+    free(labelCache.ballLabel);
+    memset(&labelCache, 0, sizeof(labelCache));
+    if (staticHud.id != 0) UnloadRenderTexture(staticHud);
+    staticHud = (RenderTexture2D){ 0 };
+    HeatmapShutdown();
+}
+
+const char *RenderModeName(RenderMode mode) {
+    switch (mode) {
+        case RENDER_CIRCLES: return "círculos";
+        case RENDER_SPRITES: return "sprites";
+        case RENDER_LOD: return "LOD";
+        case RENDER_HEATMAP: return "mapa de calor";
+        default: return "?";
+    }
+}
+
+static void DrawBallCircles(const Ball balls[], int numBalls) {
+    for (int i = 0; i < numBalls; i++) DrawCircleV(balls[i].position, balls[i].radius, balls[i].color);
+    vertexCount += 3LL * CIRCLE_SEGMENTS * numBalls;
+}
+
+//==================================================================================
+// Desenha as bolas como quads com a textura do círculo. O quad é um pouco
+// maior que o diâmetro para a borda do disco na textura cair sobre o raio da
+// bola. Sem a textura (RenderInit falhou), volta para DrawCircleV.
+//==================================================================================
+static void DrawBallSprites(const Ball balls[], int numBalls) {
+    if (circleTexture.id == 0) {
+        DrawBallCircles(balls, numBalls);
+        return;
+    }
+
+    const float scale = (SPRITE_SIZE / 2.0f) / SPRITE_RADIUS;
+    for (int start = 0; start < numBalls; start += SPRITES_PER_BATCH) {
+        int end = (start + SPRITES_PER_BATCH < numBalls) ? start + SPRITES_PER_BATCH : numBalls;
+        rlCheckRenderBatchLimit(4 * (end - start));
+
+        rlSetTexture(circleTexture.id);
+        rlBegin(RL_QUADS);
+        for (int i = start; i < end; i++) {
+            float half = balls[i].radius * scale;
+            float x = balls[i].position.x;
+            float y = balls[i].position.y;
+            rlColor4ub(balls[i].color.r, balls[i].color.g, balls[i].color.b, balls[i].color.a);
+            rlTexCoord2f(0.0f, 0.0f);
+            rlVertex2f(x - half, y - half);
+            rlTexCoord2f(0.0f, 1.0f);
+            rlVertex2f(x - half, y + half);
+            rlTexCoord2f(1.0f, 1.0f);
+            rlVertex2f(x + half, y + half);
+            rlTexCoord2f(1.0f, 0.0f);
+            rlVertex2f(x + half, y - half);
+        }
+        rlEnd();
+    }
+    rlSetTexture(0);
+    vertexCount += 4LL * numBalls;
+}
+
+//==================================================================================
+// Modo LOD: o número de segmentos de cada bola sai do raio em pixels. O erro
+// de uma corda com ângulo 2π/n num círculo de raio r é r·(1 - cos(π/n)), então
+// o nível escolhido é o primeiro com esse erro abaixo de LOD_TOLERANCE. Bolas
+// com menos de meio pixel de raio são desenhadas depois, como um quad de um
+// pixel cada.
+//==================================================================================
+static void DrawBallsLod(const Ball balls[], int numBalls, float pixelsPerUnit) {
+    float levelMaxRadius[LOD_LEVEL_COUNT];
+    for (int level = 0; level < LOD_LEVEL_COUNT; level++) {
+        levelMaxRadius[level] = LOD_TOLERANCE / (1.0f - cosf(PI / lodSegments[level]));
+    }
+
+    int points = 0;
+    for (int i = 0; i < numBalls; i++) {
+        float screenRadius = balls[i].radius * pixelsPerUnit;
+        if (screenRadius < 0.5f) {
+            points++;
+            continue;
+        }
+        int level = 0;
+        while (level < LOD_LEVEL_COUNT - 1 && screenRadius > levelMaxRadius[level]) level++;
+        int segments = lodSegments[level];
+
+        Vector2 center = balls[i].position;
+        float radius = (float)balls[i].radius;
+        rlCheckRenderBatchLimit(3 * segments);
+        rlBegin(RL_TRIANGLES);
+        rlColor4ub(balls[i].color.r, balls[i].color.g, balls[i].color.b, balls[i].color.a);
+        for (int s = 0; s < segments; s++) {
+            rlVertex2f(center.x, center.y);
+            rlVertex2f(center.x + lodCircle[level][s + 1].x * radius, center.y + lodCircle[level][s + 1].y * radius);
+            rlVertex2f(center.x + lodCircle[level][s].x * radius, center.y + lodCircle[level][s].y * radius);
+        }
+        rlEnd();
+        vertexCount += 3 * segments;
+    }
+    if (points == 0) return;
+
+    float half = 0.5f / pixelsPerUnit;
+    for (int start = 0; start < numBalls; start += SPRITES_PER_BATCH) {
+        int end = (start + SPRITES_PER_BATCH < numBalls) ? start + SPRITES_PER_BATCH : numBalls;
+        rlCheckRenderBatchLimit(4 * (end - start));
+        rlBegin(RL_QUADS);
+        for (int i = start; i < end; i++) {
+            if (balls[i].radius * pixelsPerUnit >= 0.5f) continue;
+            float x = balls[i].position.x;
+            float y = balls[i].position.y;
+            rlColor4ub(balls[i].color.r, balls[i].color.g, balls[i].color.b, balls[i].color.a);
+            rlVertex2f(x - half, y - half);
+            rlVertex2f(x - half, y + half);
+            rlVertex2f(x + half, y + half);
+            rlVertex2f(x + half, y - half);
+        }
+        rlEnd();
+    }
+    vertexCount += 4LL * points;
+}
+
+void DrawBalls(const Ball balls[], int numBalls, float pixelsPerUnit) {
+    vertexCount = 0;
+    switch (renderMode) {
+        case RENDER_SPRITES: DrawBallSprites(balls, numBalls); break;
+        case RENDER_LOD: DrawBallsLod(balls, numBalls, pixelsPerUnit); break;
+        case RENDER_HEATMAP:
+            DrawHeatmap(balls, numBalls);
+            vertexCount = 4;
+            break;
+        default: DrawBallCircles(balls, numBalls); break;
+    }
+}
+
+long long RenderVertexCount(void) {
+    return vertexCount;
+}
+
+//==================================================================================
+// Procura o rótulo de uma massa e, se ainda não existe, o desenha no atlas.
+// Retorna -1 se o atlas estiver cheio. Chamada só fora de BeginDrawing.
+//==================================================================================
+static int FindOrAddMassLabel(float mass) {
+    uint32_t bits;
+    memcpy(&bits, &mass, sizeof(bits));
+    uint32_t slot = (bits * 2654435761u) & (LABEL_TABLE_SIZE - 1);
+    while (labelCache.table[slot] != 0) {
+        int index = labelCache.table[slot] - 1;
+        if (labelCache.labels[index].mass == mass) return index;
+        slot = (slot + 1) & (LABEL_TABLE_SIZE - 1);
+    }
+    if (labelCache.labelCount == LABEL_TABLE_SIZE / 2) return -1;
+
+    const char *text = TextFormat("M:%.1f", mass);
+    int width = MeasureText(text, LABEL_FONT_SIZE) + 2;
+    if (labelCache.penX + width > LABEL_ATLAS_SIZE) {
+        labelCache.penX = 0;
+        labelCache.penY += LABEL_ROW_HEIGHT;
+    }
+    if (labelCache.penY + LABEL_ROW_HEIGHT > LABEL_ATLAS_SIZE) return -1;
+
+    BeginTextureMode(labelCache.atlas);
+    DrawText(text, labelCache.penX + 1, labelCache.penY + 1, LABEL_FONT_SIZE, WHITE);
+    EndTextureMode();
+
+    int index = labelCache.labelCount++;
+    labelCache.labels[index].mass = mass;
+    labelCache.labels[index].source = (Rectangle){ (float)labelCache.penX, (float)labelCache.penY, (float)width, LABEL_ROW_HEIGHT };
+    labelCache.table[slot] = index + 1;
+    labelCache.penX += width;
+    return index;
+}
+
+void UpdateMassLabels(const Ball balls[], int numBalls, float pixelsPerUnit) {
+    if (labelCache.atlas.id == 0) {
+        labelCache.atlas = LoadRenderTexture(LABEL_ATLAS_SIZE, LABEL_ATLAS_SIZE);
+        if (labelCache.atlas.id == 0) return;
+        BeginTextureMode(labelCache.atlas);
+        ClearBackground(BLANK);
+        EndTextureMode();
+    }
+    if (numBalls > labelCache.ballCapacity) {
+        int *ballLabel = (int *)realloc(labelCache.ballLabel, sizeof(int) * numBalls);
+        if (ballLabel == NULL) return;
+        labelCache.ballLabel = ballLabel;
+        labelCache.ballCapacity = numBalls;
+    }
+
+    bool tooMany = numBalls > LABEL_MAX_BALLS;
+    for (int i = 0; i < numBalls; i++) {
+        bool readable = !tooMany && balls[i].radius * pixelsPerUnit >= LABEL_MIN_RADIUS;
+        labelCache.ballLabel[i] = readable ? FindOrAddMassLabel(balls[i].mass) : -1;
+    }
+}
+
+//==================================================================================
+// Um quad por rótulo, num lote só com a textura do atlas. A textura de um
+// RenderTexture fica de cabeça para baixo, então a coordenada v é invertida.
+// O centro da bola é levado para a tela e o rótulo fica no mesmo
+// deslocamento de antes, em pixels inteiros para o texto não borrar.
+//==================================================================================
+void DrawMassLabels(const Ball balls[], int numBalls, Camera2D camera) {
+    if (labelCache.atlas.id == 0 || numBalls > labelCache.ballCapacity) return;
+
+    const float inverseSize = 1.0f / LABEL_ATLAS_SIZE;
+    for (int start = 0; start < numBalls; start += SPRITES_PER_BATCH) {
+        int end = (start + SPRITES_PER_BATCH < numBalls) ? start + SPRITES_PER_BATCH : numBalls;
+        rlCheckRenderBatchLimit(4 * (end - start));
+
+        rlSetTexture(labelCache.atlas.texture.id);
+        rlBegin(RL_QUADS);
+        rlColor4ub(255, 255, 255, 255);
+        for (int i = start; i < end; i++) {
+            if (labelCache.ballLabel[i] < 0) continue;
+            Rectangle source = labelCache.labels[labelCache.ballLabel[i]].source;
+            Vector2 anchor = GetWorldToScreen2D(balls[i].position, camera);
+            float x = floorf(anchor.x) - 15 - 1;
+            float y = floorf(anchor.y) - 8 - 1;
+            float u0 = source.x * inverseSize;
+            float u1 = (source.x + source.width) * inverseSize;
+            float v0 = 1.0f - source.y * inverseSize;
+            float v1 = 1.0f - (source.y + source.height) * inverseSize;
+            rlTexCoord2f(u0, v0);
+            rlVertex2f(x, y);
+            rlTexCoord2f(u0, v1);
+            rlVertex2f(x, y + source.height);
+            rlTexCoord2f(u1, v1);
+            rlVertex2f(x + source.width, y + source.height);
+            rlTexCoord2f(u1, v0);
+            rlVertex2f(x + source.width, y);
+        }
+        rlEnd();
+    }
+    rlSetTexture(0);
+}
+
+//==================================================================================
+// Textos do HUD que não mudam de um quadro para o outro, nas mesmas posições
+// de antes. Os dinâmicos (energia, FPS, trace, depuração) continuam em DrawFrame.
+// A coluna de ajuda começa em width - 170 como antes, ou mais à esquerda se a
+// linha mais larga não couber até a borda.
+//==================================================================================
+static void DrawStaticHudContents(int numBalls, int width) {
+    const char *help[8] = {
+        "Pressione [R] para reiniciar",
+        "Pressione [D] para info",
+        "Pressione [T] para gravar trace",
+        "Pressione [G] para trocar broadphase",
+        "[F5] salva / [F9] carrega snapshot",
+        "[Espaço] pausa, setas/PgUp/PgDn rebobinam",
+        NULL,
+        "Roda/botão direito: zoom e arrasto, [C] enquadra",
+    };
+    char renderLine[96];
+    if (renderMode == RENDER_HEATMAP) {
+        snprintf(renderLine, sizeof(renderLine), "[V] desenho: %s, [H] %s", RenderModeName(renderMode),
+                 HeatmapQuantityName(heatmapQuantity));
+    } else {
+        snprintf(renderLine, sizeof(renderLine), "[V] desenho: %s", RenderModeName(renderMode));
+    }
+    help[6] = renderLine;
+
+    int widest = 0;
+    for (int i = 0; i < 8; i++) {
+        int lineWidth = MeasureText(help[i], 10);
+        if (lineWidth > widest) widest = lineWidth;
+    }
+    int x = width - 170;
+    if (x + widest > width - 10) x = width - 10 - widest;
+    if (x < 0) x = 0;
+
+    DrawText(TextFormat("Bolinhas: %d", numBalls), 10, 10, 20, RAYWHITE);
+    DrawText(TextFormat("Restituição: %.2f", RESTITUTION_COEFFICIENT), 10, 35, 20, RAYWHITE);
+    for (int i = 0; i < 8; i++) DrawText(help[i], x, 40 + 15 * i, 10, GRAY);
+}
+
+void UpdateStaticHud(int numBalls) {
+    StaticHudKey key = { numBalls, renderMode, heatmapQuantity, GetScreenWidth(), GetScreenHeight() };
+    if (staticHud.id != 0 && memcmp(&key, &staticHudKey, sizeof(key)) == 0) return;
+
+    if (staticHud.id == 0 || key.screenWidth != staticHudKey.screenWidth || key.screenHeight != staticHudKey.screenHeight) {
+        if (staticHud.id != 0) UnloadRenderTexture(staticHud);
+        staticHud = LoadRenderTexture(key.screenWidth, key.screenHeight);
+        if (staticHud.id == 0) return;
+    }
+    staticHudKey = key;
+
+    BeginTextureMode(staticHud);
+    ClearBackground(BLANK);
+    DrawStaticHudContents(numBalls, key.screenWidth);
+    EndTextureMode();
+}
+
+void DrawStaticHud(void) {
+    if (staticHud.id == 0) return;
+    Rectangle source = { 0.0f, 0.0f, (float)staticHud.texture.width, -(float)staticHud.texture.height };
+    DrawTextureRec(staticHud.texture, source, (Vector2){ 0.0f, 0.0f }, WHITE);
+}
@@ -0,0 +1,53 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "sim.h"
+
+// --- Desenho das bolas ---
+// RENDER_CIRCLES usa DrawCircleV (um leque de triângulos por bola).
+// RENDER_SPRITES desenha cada bola como um quad texturizado a partir de uma
+// textura de círculo com anti-aliasing gerada uma vez, com cor e escala por
+// vértice: todas as bolas saem em poucos lotes do rlgl, sem tesselação.
+// RENDER_LOD tessela cada bola com um número de segmentos escolhido pelo
+// raio projetado na tela, e bolas menores que um pixel viram um ponto.
+// RENDER_HEATMAP troca as bolas por um mapa de calor (ver heatmap.h).
+// Todos os modos contam os vértices enviados no quadro.
+//
+// Os rótulos de massa do modo de depuração são renderizados uma vez por valor
+// num atlas (RenderTexture) e depois desenhados como um quad por bola, sem
+// TextFormat nem um quad por letra a cada quadro. Somem sozinhos quando as
+// bolas são pequenas ou numerosas demais para serem lidos.
+//
+// A parte fixa do HUD (número de bolas, restituição e a ajuda de teclas) é
+// desenhada numa RenderTexture e só é refeita quando um desses valores muda;
+// a cada quadro ela vira um único quad.
+typedef enum RenderMode {
+    RENDER_CIRCLES,
+    RENDER_SPRITES,
+    RENDER_LOD,
+    RENDER_HEATMAP,
+    RENDER_MODE_COUNT
+} RenderMode;
+
+extern RenderMode renderMode;   // [V] ou --render alterna.
+
+// Recursos de GPU do desenho; precisam da janela já aberta.
+void RenderInit(void);
+void RenderShutdown(void);
+const char *RenderModeName(RenderMode mode);
+// 'pixelsPerUnit' é a escala do mundo para a tela (o zoom da câmera).
+void DrawBalls(const Ball balls[], int numBalls, float pixelsPerUnit);
+// Vértices enviados pelo último DrawBalls.
+long long RenderVertexCount(void);
+// Garante no atlas os rótulos das bolas visíveis. Chamar antes de
+// BeginDrawing, porque pode desenhar na textura do atlas.
+void UpdateMassLabels(const Ball balls[], int numBalls, float pixelsPerUnit);
+// Desenha os rótulos preparados pela última UpdateMassLabels em pixels da
+// tela, do mesmo tamanho com qualquer zoom: chamar fora de BeginMode2D, com a
+// câmera usada para desenhar as bolas.
+void DrawMassLabels(const Ball balls[], int numBalls, Camera2D camera);
+// Refaz a textura do HUD fixo se algo nele mudou. Também antes de BeginDrawing.
+void UpdateStaticHud(int numBalls);
+void DrawStaticHud(void);
+
+#endif
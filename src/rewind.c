@@ -0,0 +1,172 @@
+#include "rewind.h"
+#include "observables.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct Keyframe {
+    long long step;
+    CollisionCounters totals;
+    DriftReference drift;
+    double wallImpulse;
+    double simTime;
+    BroadphaseMode broadphaseMode;
+    Ball *balls;   // Aponta para dentro de 'storage'.
+} Keyframe;
+
+static struct {
+    bool enabled;
+    int interval;
+    size_t budget;
+    int numBalls;
+    Ball *storage;        // capacity * numBalls bolas, alocadas de uma vez.
+    Keyframe *ring;
+    int capacity;
+    int head;             // Quadro-chave mais antigo.
+    int count;
+} history = { 0 };
+
+static Keyframe *KeyframeAt(int i) {
+    return &history.ring[(history.head + i) % history.capacity];
+}
+
+bool RewindInit(size_t budgetBytes, int interval) {
+    RewindShutdown();
+    if (budgetBytes == 0 || interval <= 0) return false;
+    history.budget = budgetBytes;
+    history.interval = interval;
+    history.enabled = true;
+    return true;
+}
+
+void RewindShutdown(void) {
+    free(history.storage);
+    free(history.ring);
+    memset(&history, 0, sizeof(history));
+}
+
+bool RewindEnabled(void) {
+    return history.enabled && history.capacity > 0;
+}
+
+int RewindInterval(void) {
+    return history.interval;
+}
+
+//==================================================================================
+// Dimensiona o anel para o número de bolas atual (quantos quadros-chave cabem
+// no orçamento, no mínimo dois) e guarda o estado atual.
+//==================================================================================
+void RewindReset(const Ball balls[], int numBalls, long long step) {
+    if (!history.enabled) return;
+
+    if (numBalls != history.numBalls || history.storage == NULL) {
+        size_t keyframeBytes = sizeof(Ball) * (size_t)(numBalls > 0 ? numBalls : 1);
+        size_t capacity = history.budget / keyframeBytes;
+        if (capacity < 2) capacity = 2;
+        if (capacity > 1 << 20) capacity = 1 << 20;
+
+        free(history.storage);
+        free(history.ring);
+        history.storage = (Ball *)malloc(keyframeBytes * capacity);
+        history.ring = (Keyframe *)malloc(sizeof(Keyframe) * capacity);
+        if (history.storage == NULL || history.ring == NULL) {
+            fprintf(stderr, "Memória insuficiente para o anel de rebobinagem; rebobinagem desligada\n");
+            RewindShutdown();
+            return;
+        }
+        history.capacity = (int)capacity;
+        history.numBalls = numBalls;
+        for (int i = 0; i < history.capacity; i++) history.ring[i].balls = history.storage + (size_t)i * numBalls;
+    }
+
+    history.head = 0;
+    history.count = 0;
+    Keyframe *first = KeyframeAt(0);
+    first->step = step;
+    first->totals = totalCounters;
+    first->drift = GetDriftReference();
+    first->wallImpulse = wallImpulse;
+    first->simTime = simTime;
+    first->broadphaseMode = broadphaseMode;
+    memcpy(first->balls, balls, sizeof(Ball) * numBalls);
+    history.count = 1;
+}
+
+//==================================================================================
+// Guarda um quadro-chave nos passos múltiplos do intervalo. Se o passo não for
+// posterior ao último guardado (a simulação continuou de um ponto rebobinado),
+// os quadros-chave à frente dele são descartados antes.
+//==================================================================================
+void RewindRecord(const Ball balls[], int numBalls, long long step) {
+    if (!RewindEnabled() || step % history.interval != 0) return;
+    RewindMark(balls, numBalls, step);
+}
+
+void RewindMark(const Ball balls[], int numBalls, long long step) {
+    if (!RewindEnabled()) return;
+    if (numBalls != history.numBalls) {
+        RewindReset(balls, numBalls, step);
+        return;
+    }
+
+    while (history.count > 0 && KeyframeAt(history.count - 1)->step >= step) history.count--;
+    if (history.count == history.capacity) {
+        history.head = (history.head + 1) % history.capacity;
+        history.count--;
+    }
+    Keyframe *keyframe = KeyframeAt(history.count);
+    keyframe->step = step;
+    keyframe->totals = totalCounters;
+    keyframe->drift = GetDriftReference();
+    keyframe->wallImpulse = wallImpulse;
+    keyframe->simTime = simTime;
+    keyframe->broadphaseMode = broadphaseMode;
+    memcpy(keyframe->balls, balls, sizeof(Ball) * numBalls);
+    history.count++;
+}
+
+//==================================================================================
+// Refaz o estado do passo pedido. Se o estado atual já estiver entre o
+// quadro-chave de partida e o alvo, continua dele em vez de copiar o
+// quadro-chave. A re-simulação usa UpdateFrame direto, sem gravar trajetória
+// nem imprimir hashes; só os quadros-chave além do último guardado são
+// registrados.
+//==================================================================================
+bool RewindSeek(Ball balls[], int numBalls, long long targetStep) {
+    if (!RewindEnabled() || fixedDeltaTime <= 0.0f || history.count == 0 || numBalls != history.numBalls) return false;
+
+    int k = history.count - 1;
+    while (k >= 0 && KeyframeAt(k)->step > targetStep) k--;
+    if (k < 0) return false;
+
+    const Keyframe *keyframe = KeyframeAt(k);
+    if (simStep < keyframe->step || simStep > targetStep) {
+        memcpy(balls, keyframe->balls, sizeof(Ball) * numBalls);
+        simStep = keyframe->step;
+        totalCounters = keyframe->totals;
+        wallImpulse = keyframe->wallImpulse;
+        simTime = keyframe->simTime;
+        SyncSystemTotals(balls, numBalls);
+        SetDriftReference(keyframe->drift);
+    }
+    broadphaseMode = keyframe->broadphaseMode;
+
+    while (simStep < targetStep) {
+        UpdateFrame(balls, numBalls, fixedDeltaTime);
+        simStep++;
+        if (simStep > KeyframeAt(history.count - 1)->step) RewindRecord(balls, numBalls, simStep);
+    }
+    return true;
+}
+
+RewindStats RewindGetStats(void) {
+    RewindStats stats = { 0 };
+    if (!RewindEnabled()) return stats;
+    stats.keyframes = history.count;
+    stats.capacity = history.capacity;
+    stats.bytes = sizeof(Ball) * (size_t)history.numBalls * history.capacity;
+    stats.oldestStep = KeyframeAt(0)->step;
+    stats.newestStep = KeyframeAt(history.count - 1)->step;
+    return stats;
+}
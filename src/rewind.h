@@ -0,0 +1,42 @@
+#ifndef REWIND_H
+#define REWIND_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "sim.h"
+
+// --- Rebobinagem ---
+// Anel em memória com uma cópia completa do estado a cada 'interval' passos,
+// limitado por um orçamento de bytes: quando enche, o quadro-chave mais
+// antigo é descartado. Qualquer passo dentro da janela coberta é refeito a
+// partir do quadro-chave anterior mais próximo, simulando de novo com o passo
+// fixo (a simulação é determinística com dt fixo). Sem --dt o anel fica
+// desligado.
+typedef struct RewindStats {
+    int keyframes;
+    int capacity;
+    size_t bytes;
+    long long oldestStep;
+    long long newestStep;
+} RewindStats;
+
+bool RewindInit(size_t budgetBytes, int interval);
+void RewindShutdown(void);
+bool RewindEnabled(void);
+int RewindInterval(void);
+// Esvazia o anel e guarda o estado atual como primeiro quadro-chave. Chamar
+// sempre que o estado mudar fora da simulação (reinício, snapshot carregado).
+void RewindReset(const Ball balls[], int numBalls, long long step);
+// Chamada a cada passo; guarda um quadro-chave nos múltiplos do intervalo.
+void RewindRecord(const Ball balls[], int numBalls, long long step);
+// Guarda um quadro-chave no passo atual fora do intervalo. Chamar quando
+// mudar algo que altera a simulação sem mudar as bolas (a broadphase, que
+// resolve as colisões em outra ordem): cada quadro-chave guarda o modo, e
+// assim nenhuma re-simulação atravessa a troca.
+void RewindMark(const Ball balls[], int numBalls, long long step);
+// Leva o estado ao passo pedido (passado ou futuro). Retorna false se o passo
+// estiver antes do quadro-chave mais antigo.
+bool RewindSeek(Ball balls[], int numBalls, long long targetStep);
+RewindStats RewindGetStats(void);
+
+#endif
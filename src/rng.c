@@ -0,0 +1,65 @@
+#include "rng.h"
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+#define PHILOX_ROUNDS 10
+
+//==================================================================================
+// Philox4x32 com 10 rodadas (Salmon et al., "Parallel random numbers: as
+// easy as 1, 2, 3"): cada rodada multiplica duas palavras do contador por
+// constantes, cruza as metades alta e baixa e mistura a chave, que avança
+// por constantes de Weyl.
+//==================================================================================
+void Philox4x32(const uint32_t key[2], const uint32_t counter[4], uint32_t out[4]) {
+    uint32_t k0 = key[0], k1 = key[1];
+    uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    for (int round = 0; round < PHILOX_ROUNDS; round++) {
+        uint64_t product0 = (uint64_t)PHILOX_M0 * c0;
+        uint64_t product1 = (uint64_t)PHILOX_M1 * c2;
+        uint32_t hi0 = (uint32_t)(product0 >> 32), lo0 = (uint32_t)product0;
+        uint32_t hi1 = (uint32_t)(product1 >> 32), lo1 = (uint32_t)product1;
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = lo1;
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = lo0;
+        k0 += PHILOX_W0;
+        k1 += PHILOX_W1;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+void RngInit(Rng *rng, uint32_t seed, RngStream stream, uint32_t id, uint64_t step) {
+    rng->key[0] = seed;
+    rng->key[1] = (uint32_t)stream;
+    rng->counter[0] = id;
+    rng->counter[1] = (uint32_t)step;
+    rng->counter[2] = (uint32_t)(step >> 32);
+    rng->counter[3] = 0;
+    rng->used = 4;
+}
+
+uint32_t RngNext(Rng *rng) {
+    if (rng->used == 4) {
+        Philox4x32(rng->key, rng->counter, rng->block);
+        rng->counter[3]++;
+        rng->used = 0;
+    }
+    return rng->block[rng->used++];
+}
+
+// Multiplicação de 32x32 bits ficando com a metade alta (Lemire): o viés é
+// no máximo range/2^32, desprezível para os intervalos usados aqui.
+int RngInt(Rng *rng, int min, int max) {
+    if (max <= min) return min;
+    uint64_t range = (uint64_t)((int64_t)max - min) + 1;
+    return (int)(min + (int64_t)(((uint64_t)RngNext(rng) * range) >> 32));
+}
+
+double RngUnit(Rng *rng) {
+    return (RngNext(rng) + 0.5) / 4294967296.0;
+}
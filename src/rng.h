@@ -0,0 +1,37 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// --- Gerador baseado em contador (Philox4x32-10) ---
+// Cada número é uma função pura de (semente, fluxo, id, passo, índice): não
+// há estado global, então qualquer thread pode gerar os números de qualquer
+// bola em qualquer ordem e o resultado não depende de quantas threads há nem
+// de quem veio antes. A chave é (semente, fluxo) e o contador de 128 bits é
+// (id, passo baixo, passo alto, índice); o índice avança a cada quatro
+// palavras. Sorteios por passo (forças estocásticas) usam o passo da
+// simulação; os da inicialização, o número da inicialização.
+typedef enum RngStream {
+    RNG_STREAM_PLACEMENT,   // Raio e posições tentadas de cada bola.
+    RNG_STREAM_APPEARANCE,  // Cor e velocidade uniforme.
+    RNG_STREAM_THERMAL,     // Velocidades gaussianas de DrawThermalVelocities.
+    RNG_STREAM_FORCE        // Reservado para forças estocásticas por passo.
+} RngStream;
+
+typedef struct Rng {
+    uint32_t key[2];
+    uint32_t counter[4];
+    uint32_t block[4];
+    int used;               // Palavras de 'block' já entregues.
+} Rng;
+
+void RngInit(Rng *rng, uint32_t seed, RngStream stream, uint32_t id, uint64_t step);
+uint32_t RngNext(Rng *rng);
+// Inteiro uniforme em [min, max].
+int RngInt(Rng *rng, int min, int max);
+// Uniforme em (0, 1), nunca 0 nem 1 (pode ir para log).
+double RngUnit(Rng *rng);
+// Bloco de quatro palavras para o contador dado, sem estado.
+void Philox4x32(const uint32_t key[2], const uint32_t counter[4], uint32_t out[4]);
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include "raylib.h"
+
+// --- Configurações da Simulação ---
+// Definidas em main.c; declaradas aqui para que os demais módulos (benchmarks,
+// ferramentas) enxerguem os mesmos parâmetros da simulação.
+extern int WIDTH;
+extern int HEIGHT;
+extern const int NUM_BALLS;
+extern const float RESTITUTION_COEFFICIENT;
+extern const int MIN_BALL_RADIUS;
+extern const int MAX_BALL_RADIUS;
+extern const float VELOCITY_SCALE;
+
+// Estrutura que define as propriedades de uma bola.
+typedef struct Ball {
+    Vector2 position;
+    Vector2 velocity;
+    int radius;
+    float mass;
+    Color color;
+} Ball;
+
+// Resultado de CheckBallCollision, usado nos contadores de eficiência da broadphase.
+typedef enum CollisionResult {
+    COLLISION_NONE,       // Não se tocam.
+    COLLISION_OVERLAP,    // Passaram no teste de distância, mas já estavam se separando.
+    COLLISION_IMPULSE     // Trocaram impulso.
+} CollisionResult;
+
+// Como os pares candidatos são gerados antes do teste exato de colisão.
+typedef enum BroadphaseMode {
+    BROADPHASE_ALL_PAIRS,   // Todos contra todos, O(n²).
+    BROADPHASE_GRID         // Grade uniforme: só células vizinhas.
+} BroadphaseMode;
+
+// Pares por etapa: gerados pela broadphase, que passaram no teste de
+// distância e que de fato trocaram impulso.
+typedef struct CollisionCounters {
+    long long candidatePairs;
+    long long overlappingPairs;
+    long long impulsePairs;
+} CollisionCounters;
+
+// Energia cinética e momento totais, atualizados a cada impulso (entre
+// bolas e nas paredes) em vez de somados bola a bola a cada quadro. A cada
+// energyCheckEvery passos são conferidos contra a soma completa (ver
+// observables.h).
+typedef struct SystemTotals {
+    double kineticEnergy;
+    double momentumX;
+    double momentumY;
+} SystemTotals;
+
+extern SystemTotals systemTotals;
+extern int energyCheckEvery;
+extern double wallImpulse;   // Impulso normal acumulado nas paredes (para a pressão).
+extern double simTime;       // Tempo simulado acumulado pelo UpdateFrame.
+
+extern BroadphaseMode broadphaseMode;
+extern float gridCellSize;
+extern CollisionCounters stepCounters;    // Contadores do último passo.
+extern CollisionCounters totalCounters;   // Acumulados desde o início da execução.
+extern unsigned int simSeed;
+extern float fixedDeltaTime;
+extern long long simStep;
+
+// Declaração das funções para que possam ser usadas antes de suas definições no código.
+int InitBalls(Ball balls[], int numBalls);   // Retorna quantas bolas couberam.
+void StepSimulation(Ball balls[], int numBalls, float deltaTime);
+void UpdateFrame(Ball balls[], int numBalls, float deltaTime);
+// 'alpha' < 1 desenha as bolas entre as posições de antes do último passo
+// fixo e as atuais; 1 desenha as atuais.
+void DrawFrame(Ball balls[], int numBalls, float kineticEnergy, float alpha);
+CollisionResult CheckBallCollision(Ball *ball1, Ball *ball2);
+void CheckWallCollision(Ball *ball);
+
+
+#endif
@@ -0,0 +1,225 @@
+#include "snapshot.h"
+#include "mapped_file.h"
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Tamanho do cabeçalho de cada versão (índice 0 não usado).
+static const size_t headerSizes[SNAPSHOT_VERSION + 1] = {
+    0, SNAPSHOT_V1_HEADER_SIZE, SNAPSHOT_V2_HEADER_SIZE, SNAPSHOT_V3_HEADER_SIZE, SNAPSHOT_V4_HEADER_SIZE,
+    SNAPSHOT_V5_HEADER_SIZE, sizeof(SnapshotHeader)
+};
+
+// Tamanho em bytes de um elemento de cada seção.
+static const size_t sectionElementSize[SECTION_COUNT] = {
+    sizeof(float), sizeof(float), sizeof(float), sizeof(float), sizeof(int32_t), sizeof(float), sizeof(uint32_t)
+};
+
+static uint64_t AlignUp(uint64_t value) {
+    return (value + SNAPSHOT_ALIGNMENT - 1) & ~(uint64_t)(SNAPSHOT_ALIGNMENT - 1);
+}
+
+//==================================================================================
+// Calcula o deslocamento de cada seção (e do histórico de energia, se houver)
+// e devolve o tamanho total do arquivo.
+//==================================================================================
+static uint64_t ComputeLayout(SnapshotHeader *header) {
+    uint64_t offset = AlignUp(sizeof(SnapshotHeader));
+    for (int s = 0; s < SECTION_COUNT; s++) {
+        header->sectionOffset[s] = offset;
+        offset = AlignUp(offset + sectionElementSize[s] * header->numBalls);
+    }
+    if (header->energyCount > 0) {
+        header->energyOffset = offset;
+        offset = AlignUp(offset + sizeof(float) * header->energyCount);
+    }
+    return offset;
+}
+
+//==================================================================================
+// Grava o snapshot: preenche o cabeçalho e espalha os campos das bolas em
+// vetores separados diretamente na memória mapeada do arquivo.
+//==================================================================================
+bool SaveSnapshot(const char *path, const Ball balls[], int numBalls, const SnapshotRun *run) {
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.headerSize = sizeof(SnapshotHeader);
+    header.numBalls = (uint64_t)numBalls;
+    header.step = (uint64_t)simStep;
+    header.seed = simSeed;
+    header.deltaTime = fixedDeltaTime;
+    header.worldWidth = WIDTH;
+    header.worldHeight = HEIGHT;
+    header.candidatePairs = (uint64_t)totalCounters.candidatePairs;
+    header.overlappingPairs = (uint64_t)totalCounters.overlappingPairs;
+    header.impulsePairs = (uint64_t)totalCounters.impulsePairs;
+    header.broadphaseMode = (int32_t)broadphaseMode;
+    header.cellSize = gridCellSize;
+    DriftReference drift = GetDriftReference();
+    header.referenceEnergy = drift.energy;
+    header.referenceStep = (uint64_t)drift.step;
+    header.wallImpulse = wallImpulse;
+    header.simTime = simTime;
+    if (run != NULL) {
+        header.runStartStep = (uint64_t)run->startStep;
+        header.runEndStep = (uint64_t)run->endStep;
+        header.energyCount = (run->energyHistory != NULL && run->energyCount > 0) ? (uint64_t)run->energyCount : 0;
+        header.csvBytes = (run->csvBytes > 0) ? (uint64_t)run->csvBytes : 0;
+        header.reportEvery = run->reportEvery;
+        header.energyCheckEvery = run->energyCheckEvery;
+    }
+    uint64_t fileSize = ComputeLayout(&header);
+
+    MappedFile file;
+    if (!MapFileCreate(&file, path, (size_t)fileSize)) {
+        fprintf(stderr, "Não foi possível criar o snapshot %s\n", path);
+        return false;
+    }
+
+    unsigned char *base = (unsigned char *)file.data;
+    memcpy(base, &header, sizeof(header));
+    float *posX = (float *)(base + header.sectionOffset[SECTION_POSITION_X]);
+    float *posY = (float *)(base + header.sectionOffset[SECTION_POSITION_Y]);
+    float *velX = (float *)(base + header.sectionOffset[SECTION_VELOCITY_X]);
+    float *velY = (float *)(base + header.sectionOffset[SECTION_VELOCITY_Y]);
+    int32_t *radius = (int32_t *)(base + header.sectionOffset[SECTION_RADIUS]);
+    float *mass = (float *)(base + header.sectionOffset[SECTION_MASS]);
+    uint32_t *color = (uint32_t *)(base + header.sectionOffset[SECTION_COLOR]);
+
+    for (int i = 0; i < numBalls; i++) {
+        posX[i] = balls[i].position.x;
+        posY[i] = balls[i].position.y;
+        velX[i] = balls[i].velocity.x;
+        velY[i] = balls[i].velocity.y;
+        radius[i] = balls[i].radius;
+        mass[i] = balls[i].mass;
+        memcpy(&color[i], &balls[i].color, sizeof(uint32_t));
+    }
+    if (header.energyCount > 0) memcpy(base + header.energyOffset, run->energyHistory, sizeof(float) * header.energyCount);
+
+    return UnmapFile(&file);
+}
+
+//==================================================================================
+// Lê um snapshot: valida o cabeçalho e os limites de cada seção antes de
+// copiar os vetores mapeados para as bolas.
+//==================================================================================
+bool LoadSnapshot(const char *path, Ball **balls, int *numBalls, SnapshotInfo *info) {
+    MappedFile file;
+    if (!MapFileRead(&file, path)) {
+        fprintf(stderr, "Não foi possível abrir o snapshot %s\n", path);
+        return false;
+    }
+
+    // Lê só o cabeçalho da versão do arquivo; os campos que ela não tem ficam zerados.
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    bool valid = file.size >= SNAPSHOT_V1_HEADER_SIZE;
+    if (valid) {
+        memcpy(&header, file.data, SNAPSHOT_V1_HEADER_SIZE);
+        bool known = header.version >= 1 && header.version <= SNAPSHOT_VERSION;
+        size_t expectedSize = known ? headerSizes[header.version] : 0;
+        valid = memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) == 0 && known &&
+                header.headerSize == expectedSize && file.size >= expectedSize && header.numBalls > 0 &&
+                header.numBalls <= 0x7FFFFFFF;
+        if (valid) memcpy(&header, file.data, expectedSize);
+    }
+    for (int s = 0; valid && s < SECTION_COUNT; s++) {
+        valid = header.sectionOffset[s] % SNAPSHOT_ALIGNMENT == 0 && header.sectionOffset[s] <= file.size &&
+                sectionElementSize[s] * header.numBalls <= file.size - header.sectionOffset[s];
+    }
+    if (valid && header.energyCount > 0) {
+        valid = header.energyCount <= 0x7FFFFFFF && header.energyOffset % SNAPSHOT_ALIGNMENT == 0 &&
+                header.energyOffset <= file.size && sizeof(float) * header.energyCount <= file.size - header.energyOffset;
+    }
+    if (!valid) {
+        fprintf(stderr, "Snapshot inválido ou de versão desconhecida: %s\n", path);
+        UnmapFile(&file);
+        return false;
+    }
+
+    // Valores que a simulação não tem como usar (e que deixariam a grade ou
+    // as colisões em estado indefinido) invalidam o arquivo inteiro. A célula
+    // da grade e o alcance das consultas contam com raios até MAX_BALL_RADIUS.
+    const unsigned char *base = (const unsigned char *)file.data;
+    const int32_t *radius = (const int32_t *)(base + header.sectionOffset[SECTION_RADIUS]);
+    const float *mass = (const float *)(base + header.sectionOffset[SECTION_MASS]);
+    if (header.worldWidth <= 0 || header.worldHeight <= 0) {
+        fprintf(stderr, "Snapshot com tamanho de mundo inválido (%dx%d): %s\n", header.worldWidth, header.worldHeight, path);
+        UnmapFile(&file);
+        return false;
+    }
+    for (uint64_t i = 0; i < header.numBalls; i++) {
+        if (radius[i] <= 0 || radius[i] > MAX_BALL_RADIUS || !isfinite(mass[i]) || mass[i] <= 0.0f) {
+            fprintf(stderr, "Snapshot com raio ou massa inválidos na bola %llu: %s\n", (unsigned long long)i, path);
+            UnmapFile(&file);
+            return false;
+        }
+    }
+
+    float *energyHistory = NULL;
+    if (header.energyCount > 0) {
+        energyHistory = (float *)malloc(sizeof(float) * header.energyCount);
+        if (energyHistory == NULL) {
+            fprintf(stderr, "Memória insuficiente para o histórico de energia\n");
+            UnmapFile(&file);
+            return false;
+        }
+        memcpy(energyHistory, base + header.energyOffset, sizeof(float) * header.energyCount);
+    }
+
+    int count = (int)header.numBalls;
+    Ball *resized = (Ball *)realloc(*balls, sizeof(Ball) * count);
+    if (resized == NULL) {
+        fprintf(stderr, "Memória insuficiente para %d bolas\n", count);
+        free(energyHistory);
+        UnmapFile(&file);
+        return false;
+    }
+
+    const float *posX = (const float *)(base + header.sectionOffset[SECTION_POSITION_X]);
+    const float *posY = (const float *)(base + header.sectionOffset[SECTION_POSITION_Y]);
+    const float *velX = (const float *)(base + header.sectionOffset[SECTION_VELOCITY_X]);
+    const float *velY = (const float *)(base + header.sectionOffset[SECTION_VELOCITY_Y]);
+    const uint32_t *color = (const uint32_t *)(base + header.sectionOffset[SECTION_COLOR]);
+
+    for (int i = 0; i < count; i++) {
+        resized[i].position = (Vector2){ posX[i], posY[i] };
+        resized[i].velocity = (Vector2){ velX[i], velY[i] };
+        resized[i].radius = radius[i];
+        resized[i].mass = mass[i];
+        memcpy(&resized[i].color, &color[i], sizeof(uint32_t));
+    }
+
+    *balls = resized;
+    *numBalls = count;
+    memset(info, 0, sizeof(*info));
+    info->step = (long long)header.step;
+    info->seed = header.seed;
+    info->deltaTime = header.deltaTime;
+    info->worldWidth = header.worldWidth;
+    info->worldHeight = header.worldHeight;
+    info->totals.candidatePairs = (long long)header.candidatePairs;
+    info->totals.overlappingPairs = (long long)header.overlappingPairs;
+    info->totals.impulsePairs = (long long)header.impulsePairs;
+    info->broadphaseMode = (header.broadphaseMode == BROADPHASE_GRID) ? BROADPHASE_GRID : BROADPHASE_ALL_PAIRS;
+    info->cellSize = header.cellSize;
+    info->run.startStep = (long long)header.runStartStep;
+    info->run.endStep = (long long)header.runEndStep;
+    info->run.energyHistory = energyHistory;
+    info->run.energyCount = (int)header.energyCount;
+    info->run.csvBytes = (header.csvBytes <= (uint64_t)LLONG_MAX) ? (long long)header.csvBytes : 0;
+    info->run.reportEvery = (header.version >= 6 && header.reportEvery > 0) ? header.reportEvery : -1;
+    info->run.energyCheckEvery = (header.version >= 6 && header.energyCheckEvery >= 0) ? header.energyCheckEvery : -1;
+    info->drift.energy = header.referenceEnergy;
+    info->drift.step = (long long)header.referenceStep;
+    info->hasDriftReference = header.version >= 4 && isfinite(header.referenceEnergy) && header.referenceStep <= header.step;
+    info->wallImpulse = isfinite(header.wallImpulse) ? header.wallImpulse : 0.0;
+    info->simTime = isfinite(header.simTime) ? header.simTime : 0.0;
+    UnmapFile(&file);
+    return true;
+}
@@ -0,0 +1,118 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sim.h"
+#include "observables.h"
+
+// --- Snapshots binários ---
+// Formato versionado: cabeçalho fixo seguido de um vetor por campo das bolas
+// (SoA), cada um alinhado em 64 bytes. Escrito e lido por mmap. Os campos
+// numéricos são gravados na ordem de bytes da máquina (little-endian nas
+// plataformas suportadas).
+// A versão 2 acrescenta ao cabeçalho o que um checkpoint precisa para
+// continuar uma execução sem janela: contadores acumulados, broadphase, os
+// passos inicial e final da execução e um vetor com o histórico de energia.
+// A versão 3 guarda o tamanho do CSV no momento do checkpoint, para que o
+// --resume descarte as linhas gravadas depois dele; a 4, a referência da
+// deriva de energia; a 5, o impulso nas paredes e o tempo simulado
+// acumulados, de que a pressão depende; e a 6, os intervalos de relatório
+// e de conferência da energia, que o --resume mantém.
+// Cada versão só acrescenta campos no fim do cabeçalho, e todas as
+// anteriores continuam sendo lidas.
+#define SNAPSHOT_MAGIC "SIMCOL2D"
+#define SNAPSHOT_VERSION 6
+#define SNAPSHOT_ALIGNMENT 64
+
+typedef enum SnapshotSection {
+    SECTION_POSITION_X,
+    SECTION_POSITION_Y,
+    SECTION_VELOCITY_X,
+    SECTION_VELOCITY_Y,
+    SECTION_RADIUS,
+    SECTION_MASS,
+    SECTION_COLOR,
+    SECTION_COUNT
+} SnapshotSection;
+
+// Cabeçalho gravado no início do arquivo. Os campos estão em ordem que não
+// gera preenchimento, então o layout em disco é o mesmo do struct.
+typedef struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t numBalls;
+    uint64_t step;
+    uint32_t seed;
+    float deltaTime;
+    int32_t worldWidth;
+    int32_t worldHeight;
+    uint64_t sectionOffset[SECTION_COUNT];
+    // Versão 2.
+    uint64_t candidatePairs;
+    uint64_t overlappingPairs;
+    uint64_t impulsePairs;
+    int32_t broadphaseMode;
+    float cellSize;
+    uint64_t runStartStep;
+    uint64_t runEndStep;        // 0 se o snapshot não veio de um checkpoint.
+    uint64_t energyCount;
+    uint64_t energyOffset;      // Vetor de floats, 0 se energyCount for 0.
+    // Versão 3.
+    uint64_t csvBytes;          // Tamanho do CSV da execução, 0 se não houver.
+    // Versão 4.
+    double referenceEnergy;
+    uint64_t referenceStep;
+    // Versão 5.
+    double wallImpulse;
+    double simTime;
+    // Versão 6.
+    int32_t reportEvery;
+    int32_t energyCheckEvery;
+} SnapshotHeader;
+
+// Tamanho do cabeçalho das versões anteriores, que terminam no último campo
+// que cada uma acrescentou.
+#define SNAPSHOT_V1_HEADER_SIZE offsetof(SnapshotHeader, candidatePairs)
+#define SNAPSHOT_V2_HEADER_SIZE offsetof(SnapshotHeader, csvBytes)
+#define SNAPSHOT_V3_HEADER_SIZE offsetof(SnapshotHeader, referenceEnergy)
+#define SNAPSHOT_V4_HEADER_SIZE offsetof(SnapshotHeader, wallImpulse)
+#define SNAPSHOT_V5_HEADER_SIZE offsetof(SnapshotHeader, reportEvery)
+
+// Progresso de uma execução sem janela, gravado nos checkpoints.
+typedef struct SnapshotRun {
+    long long startStep;        // Passo em que a execução começou.
+    long long endStep;          // Passo em que ela termina.
+    float *energyHistory;       // Energia a cada linha de relatório.
+    int energyCount;
+    long long csvBytes;         // Bytes já gravados no CSV (0 sem CSV).
+    int reportEvery;            // Passos por linha do CSV e amostra de energia.
+    int energyCheckEvery;       // 0 desliga; -1 nos dois em arquivos anteriores à versão 6.
+} SnapshotRun;
+
+// Metadados lidos de um snapshot, aplicados pelo chamador.
+typedef struct SnapshotInfo {
+    long long step;
+    unsigned int seed;
+    float deltaTime;
+    int worldWidth;
+    int worldHeight;
+    CollisionCounters totals;   // Zerados em arquivos da versão 1.
+    BroadphaseMode broadphaseMode;
+    float cellSize;
+    SnapshotRun run;            // energyHistory é alocado por LoadSnapshot (o chamador libera).
+    DriftReference drift;
+    bool hasDriftReference;     // Falso em arquivos anteriores à versão 4.
+    double wallImpulse;         // Zerados em arquivos anteriores à versão 5.
+    double simTime;
+} SnapshotInfo;
+
+// Grava o estado atual (bolas, passo, semente, dt, tamanho do mundo,
+// broadphase, contadores acumulados, referência da deriva, impulso nas
+// paredes e tempo simulado) e, se dado, o progresso da execução.
+bool SaveSnapshot(const char *path, const Ball balls[], int numBalls, const SnapshotRun *run);
+// Lê um snapshot, redimensionando o vetor de bolas se preciso.
+bool LoadSnapshot(const char *path, Ball **balls, int *numBalls, SnapshotInfo *info);
+
+#endif
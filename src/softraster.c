@@ -0,0 +1,318 @@
+#include "softraster.h"
+#include "threadpool.h"
+#include "timer.h"
+#include "view.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Bolas por thread abaixo das quais a distribuição pelos blocos roda numa só.
+#define BIN_MIN_BALLS_PER_WORKER 8192
+
+static struct {
+    bool active;
+    char *path;
+    int every;
+    int width;
+    int height;
+    unsigned char *pixels;     // RGBA8, linha a linha.
+    unsigned char *row;        // Uma linha RGB para o PPM.
+    int tilesX;
+    int tilesY;
+    int *counts;               // Bolas por bloco e thread: counts[worker * tiles + tile].
+    int *tileStart;            // Início de cada bloco em 'entries' (tiles + 1).
+    int *entries;              // Índices das bolas, agrupados por bloco.
+    int entryCapacity;
+    FrameExportStats stats;
+} raster = { 0 };
+
+// Câmera que enquadra o mundo, como ViewFit: tela = mundo * zoom + offset.
+typedef struct RasterContext {
+    const Ball *balls;
+    float zoom;
+    float offsetX;
+    float offsetY;
+} RasterContext;
+
+bool FrameExportStart(const FrameExportOptions *options) {
+    FrameExportStop();
+    int width = options->width;
+    int height = options->height;
+    if (width <= 0 || height <= 0) {
+        width = (WIDTH < MAX_WINDOW_WIDTH) ? WIDTH : MAX_WINDOW_WIDTH;
+        height = (HEIGHT < MAX_WINDOW_HEIGHT) ? HEIGHT : MAX_WINDOW_HEIGHT;
+    }
+    raster.tilesX = (width + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    raster.tilesY = (height + RASTER_TILE_SIZE - 1) / RASTER_TILE_SIZE;
+    int tiles = raster.tilesX * raster.tilesY;
+
+    raster.path = (char *)malloc(strlen(options->path) + 1);
+    raster.pixels = (unsigned char *)malloc((size_t)width * height * 4);
+    raster.row = (unsigned char *)malloc((size_t)width * 3);
+    raster.counts = (int *)malloc(sizeof(int) * tiles * THREADPOOL_MAX_WORKERS);
+    raster.tileStart = (int *)malloc(sizeof(int) * (tiles + 1));
+    if (raster.path == NULL || raster.pixels == NULL || raster.row == NULL || raster.counts == NULL ||
+        raster.tileStart == NULL) {
+        fprintf(stderr, "Memória insuficiente para quadros de %dx%d\n", width, height);
+        FrameExportStop();
+        return false;
+    }
+    strcpy(raster.path, options->path);
+    raster.every = (options->every > 0) ? options->every : 1;
+    raster.width = width;
+    raster.height = height;
+    raster.active = true;
+    return true;
+}
+
+bool FrameExportActive(void) {
+    return raster.active;
+}
+
+FrameExportStats FrameExportGetStats(void) {
+    return raster.stats;
+}
+
+void FrameExportStop(void) {
+    free(raster.path);
+    free(raster.pixels);
+    free(raster.row);
+    free(raster.counts);
+    free(raster.tileStart);
+    free(raster.entries);
+    memset(&raster, 0, sizeof(raster));
+}
+
+//==================================================================================
+// Retângulo de blocos tocado pela bola (vazio se estiver fora da imagem). A
+// margem de meio pixel cobre a borda antisserrilhada.
+//==================================================================================
+static bool BallTiles(const RasterContext *context, const Ball *ball, int *tx0, int *ty0, int *tx1, int *ty1) {
+    float x = ball->position.x * context->zoom + context->offsetX;
+    float y = ball->position.y * context->zoom + context->offsetY;
+    float r = ball->radius * context->zoom + 0.5f;
+    if (x + r < 0.0f || y + r < 0.0f || x - r >= raster.width || y - r >= raster.height) return false;
+
+    *tx0 = (x - r <= 0.0f) ? 0 : (int)(x - r) / RASTER_TILE_SIZE;
+    *ty0 = (y - r <= 0.0f) ? 0 : (int)(y - r) / RASTER_TILE_SIZE;
+    *tx1 = (x + r >= raster.width) ? raster.tilesX - 1 : (int)(x + r) / RASTER_TILE_SIZE;
+    *ty1 = (y + r >= raster.height) ? raster.tilesY - 1 : (int)(y + r) / RASTER_TILE_SIZE;
+    return true;
+}
+
+static void CountTiles(void *context, int begin, int end, int worker) {
+    const RasterContext *frame = (const RasterContext *)context;
+    int *counts = raster.counts + (size_t)worker * raster.tilesX * raster.tilesY;
+    for (int i = begin; i < end; i++) {
+        int tx0, ty0, tx1, ty1;
+        if (!BallTiles(frame, &frame->balls[i], &tx0, &ty0, &tx1, &ty1)) continue;
+        for (int ty = ty0; ty <= ty1; ty++) {
+            for (int tx = tx0; tx <= tx1; tx++) counts[ty * raster.tilesX + tx]++;
+        }
+    }
+}
+
+// Segunda passada, com a mesma divisão da primeira: 'counts' agora guarda a
+// próxima posição livre de cada thread em cada bloco.
+static void FillTiles(void *context, int begin, int end, int worker) {
+    const RasterContext *frame = (const RasterContext *)context;
+    int *next = raster.counts + (size_t)worker * raster.tilesX * raster.tilesY;
+    for (int i = begin; i < end; i++) {
+        int tx0, ty0, tx1, ty1;
+        if (!BallTiles(frame, &frame->balls[i], &tx0, &ty0, &tx1, &ty1)) continue;
+        for (int ty = ty0; ty <= ty1; ty++) {
+            for (int tx = tx0; tx <= tx1; tx++) raster.entries[next[ty * raster.tilesX + tx]++] = i;
+        }
+    }
+}
+
+static void BlendPixel(unsigned char *pixel, Color color, float coverage) {
+    int a = (int)(coverage * color.a + 0.5f);
+    if (a <= 0) return;
+    pixel[0] = (unsigned char)(pixel[0] + (((int)color.r - pixel[0]) * a) / 255);
+    pixel[1] = (unsigned char)(pixel[1] + (((int)color.g - pixel[1]) * a) / 255);
+    pixel[2] = (unsigned char)(pixel[2] + (((int)color.b - pixel[2]) * a) / 255);
+}
+
+//==================================================================================
+// Disco com antisserrilhado, recortado ao bloco [x0, x1) x [y0, y1). A
+// cobertura de cada pixel é aproximada pela distância do centro do pixel à
+// borda (1 dentro, 0 fora, linear na faixa de um pixel em volta do raio).
+// Bolas com menos de meio pixel de raio viram um pixel com a cobertura da
+// área, como os quads de 1 px do modo LOD.
+//==================================================================================
+static void DrawDisk(float cx, float cy, float r, Color color, int x0, int y0, int x1, int y1) {
+    if (r < 0.5f) {
+        int px = (int)floorf(cx);
+        int py = (int)floorf(cy);
+        if (px >= x0 && px < x1 && py >= y0 && py < y1) {
+            BlendPixel(raster.pixels + ((size_t)py * raster.width + px) * 4, color, PI * r * r);
+        }
+        return;
+    }
+
+    int left = (int)floorf(cx - r - 0.5f);
+    int top = (int)floorf(cy - r - 0.5f);
+    int right = (int)ceilf(cx + r + 0.5f);
+    int bottom = (int)ceilf(cy + r + 0.5f);
+    if (left < x0) left = x0;
+    if (top < y0) top = y0;
+    if (right > x1) right = x1;
+    if (bottom > y1) bottom = y1;
+
+    float inner = (r > 0.5f) ? (r - 0.5f) * (r - 0.5f) : 0.0f;
+    float outer = (r + 0.5f) * (r + 0.5f);
+    for (int py = top; py < bottom; py++) {
+        float dy = py + 0.5f - cy;
+        unsigned char *pixel = raster.pixels + ((size_t)py * raster.width + left) * 4;
+        for (int px = left; px < right; px++, pixel += 4) {
+            float dx = px + 0.5f - cx;
+            float distSq = dx * dx + dy * dy;
+            if (distSq >= outer) continue;
+            if (distSq <= inner) {
+                BlendPixel(pixel, color, 1.0f);
+            } else {
+                BlendPixel(pixel, color, r + 0.5f - sqrtf(distSq));
+            }
+        }
+    }
+}
+
+// Limpa cada bloco e desenha as suas bolas na ordem do vetor.
+static void RasterTiles(void *context, int begin, int end, int worker) {
+    (void)worker;
+    const RasterContext *frame = (const RasterContext *)context;
+    for (int tile = begin; tile < end; tile++) {
+        int x0 = (tile % raster.tilesX) * RASTER_TILE_SIZE;
+        int y0 = (tile / raster.tilesX) * RASTER_TILE_SIZE;
+        int x1 = (x0 + RASTER_TILE_SIZE < raster.width) ? x0 + RASTER_TILE_SIZE : raster.width;
+        int y1 = (y0 + RASTER_TILE_SIZE < raster.height) ? y0 + RASTER_TILE_SIZE : raster.height;
+        for (int y = y0; y < y1; y++) {
+            unsigned char *pixel = raster.pixels + ((size_t)y * raster.width + x0) * 4;
+            for (int x = x0; x < x1; x++, pixel += 4) {
+                pixel[0] = BLACK.r;
+                pixel[1] = BLACK.g;
+                pixel[2] = BLACK.b;
+                pixel[3] = 255;
+            }
+        }
+
+        for (int e = raster.tileStart[tile]; e < raster.tileStart[tile + 1]; e++) {
+            const Ball *ball = &frame->balls[raster.entries[e]];
+            DrawDisk(ball->position.x * frame->zoom + frame->offsetX, ball->position.y * frame->zoom + frame->offsetY,
+                     ball->radius * frame->zoom, ball->color, x0, y0, x1, y1);
+        }
+    }
+}
+
+// Linha horizontal ou vertical de um pixel, recortada à imagem.
+static void DrawSpan(int x0, int y0, int x1, int y1, Color color) {
+    if (x0 < 0) x0 = 0;
+    if (y0 < 0) y0 = 0;
+    if (x1 >= raster.width) x1 = raster.width - 1;
+    if (y1 >= raster.height) y1 = raster.height - 1;
+    for (int y = y0; y <= y1; y++) {
+        for (int x = x0; x <= x1; x++) BlendPixel(raster.pixels + ((size_t)y * raster.width + x) * 4, color, 1.0f);
+    }
+}
+
+//==================================================================================
+// Distribui as bolas pelos blocos (contagem por thread, soma de prefixos e
+// preenchimento), desenha os blocos em paralelo e por fim a borda do mundo,
+// como o DrawRectangleLines do DrawFrame.
+//==================================================================================
+static bool RasterizeFrame(const Ball balls[], int numBalls) {
+    RasterContext context = { balls, 0.0f, 0.0f, 0.0f };
+    float zoomX = (float)raster.width / WIDTH;
+    float zoomY = (float)raster.height / HEIGHT;
+    context.zoom = (zoomX < zoomY) ? zoomX : zoomY;
+    context.offsetX = raster.width / 2.0f - WIDTH / 2.0f * context.zoom;
+    context.offsetY = raster.height / 2.0f - HEIGHT / 2.0f * context.zoom;
+
+    int tiles = raster.tilesX * raster.tilesY;
+    memset(raster.counts, 0, sizeof(int) * tiles * THREADPOOL_MAX_WORKERS);
+    ParallelFor(numBalls, BIN_MIN_BALLS_PER_WORKER, CountTiles, &context);
+
+    // Em cada bloco, as bolas da thread 0 vêm antes das da thread 1 e assim
+    // por diante, o que mantém a ordem do vetor.
+    int total = 0;
+    for (int t = 0; t < tiles; t++) {
+        raster.tileStart[t] = total;
+        for (int w = 0; w < THREADPOOL_MAX_WORKERS; w++) {
+            int count = raster.counts[w * tiles + t];
+            raster.counts[w * tiles + t] = total;
+            total += count;
+        }
+    }
+    raster.tileStart[tiles] = total;
+    if (total > raster.entryCapacity) {
+        int *entries = (int *)realloc(raster.entries, sizeof(int) * total);
+        if (entries == NULL) return false;
+        raster.entries = entries;
+        raster.entryCapacity = total;
+    }
+    ParallelFor(numBalls, BIN_MIN_BALLS_PER_WORKER, FillTiles, &context);
+    ParallelFor(tiles, 1, RasterTiles, &context);
+
+    int left = (int)floorf(context.offsetX);
+    int top = (int)floorf(context.offsetY);
+    int right = (int)floorf(WIDTH * context.zoom + context.offsetX) - 1;
+    int bottom = (int)floorf(HEIGHT * context.zoom + context.offsetY) - 1;
+    DrawSpan(left, top, right, top, DARKGRAY);
+    DrawSpan(left, bottom, right, bottom, DARKGRAY);
+    DrawSpan(left, top + 1, left, bottom - 1, DARKGRAY);
+    DrawSpan(right, top + 1, right, bottom - 1, DARKGRAY);
+    return true;
+}
+
+static bool WritePpm(const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) return false;
+    bool ok = fprintf(file, "P6\n%d %d\n255\n", raster.width, raster.height) > 0;
+    for (int y = 0; ok && y < raster.height; y++) {
+        const unsigned char *pixel = raster.pixels + (size_t)y * raster.width * 4;
+        for (int x = 0; x < raster.width; x++) memcpy(raster.row + x * 3, pixel + x * 4, 3);
+        ok = fwrite(raster.row, 3, raster.width, file) == (size_t)raster.width;
+    }
+    return (fclose(file) == 0) && ok;
+}
+
+//==================================================================================
+// quadro.png no passo 100 vira quadro_00000100.png; sem extensão, o quadro
+// é gravado em PPM.
+//==================================================================================
+static bool WriteFrame(long long step) {
+    const char *slash = strrchr(raster.path, '/');
+    const char *backslash = strrchr(raster.path, '\\');
+    if (backslash > slash) slash = backslash;
+    const char *dot = strrchr(raster.path, '.');
+    if (dot == NULL || (slash != NULL && dot < slash)) dot = raster.path + strlen(raster.path);
+    const char *extension = (*dot != '\0') ? dot : ".ppm";
+
+    char name[1024];
+    int length = snprintf(name, sizeof(name), "%.*s_%08lld%s", (int)(dot - raster.path), raster.path, step, extension);
+    if (length < 0 || length >= (int)sizeof(name)) return false;
+
+    bool ppm = (strcmp(extension, ".ppm") == 0) || (strcmp(extension, ".PPM") == 0);
+    if (ppm) return WritePpm(name);
+    Image image = { raster.pixels, raster.width, raster.height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+    return ExportImage(image, name);
+}
+
+bool FrameExportStep(const Ball balls[], int numBalls, long long step) {
+    if (!raster.active || step % raster.every != 0) return true;
+
+    uint64_t start = TimerNowNs();
+    bool ok = RasterizeFrame(balls, numBalls);
+    uint64_t drawn = TimerNowNs();
+    ok = ok && WriteFrame(step);
+    raster.stats.rasterMs += (drawn - start) / 1e6;
+    raster.stats.writeMs += (TimerNowNs() - drawn) / 1e6;
+    if (!ok) {
+        fprintf(stderr, "Falha ao gravar o quadro do passo %lld\n", step);
+        return false;
+    }
+    raster.stats.frames++;
+    return true;
+}
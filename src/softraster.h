@@ -0,0 +1,39 @@
+#ifndef SOFTRASTER_H
+#define SOFTRASTER_H
+
+#include <stdbool.h>
+#include "sim.h"
+
+// --- Quadros sem janela ---
+// Rasterizador na CPU para execuções sem janela (e sem GPU): desenha o mesmo
+// que DrawFrame com a câmera enquadrando o mundo (fundo preto, bolas como
+// discos com antisserrilhado e a borda do mundo), sem os textos do HUD. A
+// imagem é dividida em blocos de RASTER_TILE_SIZE pixels; as bolas são
+// distribuídas pelos blocos que tocam, na ordem do vetor (a última fica por
+// cima, como no DrawFrame), e cada thread do ParallelFor desenha os seus
+// blocos. A cada 'every' passos o quadro é gravado em PNG (ExportImage do
+// raylib, que não precisa de janela) ou PPM, conforme a extensão.
+#define RASTER_TILE_SIZE 64
+
+typedef struct FrameExportOptions {
+    const char *path;   // Nome base: o passo entra antes da extensão (quadro.png -> quadro_00000100.png).
+    int every;          // Grava um quadro a cada 'every' passos.
+    int width;          // Tamanho da imagem; 0 usa o da janela que o
+    int height;         // DrawFrame abriria para este mundo.
+} FrameExportOptions;
+
+typedef struct FrameExportStats {
+    long long frames;
+    double rasterMs;    // Tempo total desenhando.
+    double writeMs;     // Tempo total codificando e gravando os arquivos.
+} FrameExportStats;
+
+bool FrameExportStart(const FrameExportOptions *options);
+bool FrameExportActive(void);
+// Desenha e grava o quadro se 'step' for múltiplo do intervalo. Retorna
+// false só se a gravação falhar.
+bool FrameExportStep(const Ball balls[], int numBalls, long long step);
+FrameExportStats FrameExportGetStats(void);
+void FrameExportStop(void);
+
+#endif
@@ -0,0 +1,92 @@
+#include "statehash.h"
+#include <string.h>
+
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+
+static uint64_t RotateLeft64(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+static uint64_t Read64(const unsigned char *p) {
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t Read32(const unsigned char *p) {
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint64_t Round64(uint64_t accumulator, uint64_t input) {
+    accumulator += input * PRIME64_2;
+    accumulator = RotateLeft64(accumulator, 31);
+    return accumulator * PRIME64_1;
+}
+
+static uint64_t MergeRound64(uint64_t hash, uint64_t accumulator) {
+    hash ^= Round64(0, accumulator);
+    return hash * PRIME64_1 + PRIME64_4;
+}
+
+//==================================================================================
+// xxHash64. O laço principal mantém as quatro faixas num vetor para que o
+// compilador possa processá-las em paralelo; a saída segue a referência.
+//==================================================================================
+uint64_t HashBytes64(const void *data, size_t length, uint64_t seed) {
+    const unsigned char *p = (const unsigned char *)data;
+    const unsigned char *end = p + length;
+    uint64_t hash;
+
+    if (length >= 32) {
+        uint64_t lanes[4] = { seed + PRIME64_1 + PRIME64_2, seed + PRIME64_2, seed, seed - PRIME64_1 };
+        const unsigned char *limit = end - 32;
+        do {
+            for (int l = 0; l < 4; l++) lanes[l] = Round64(lanes[l], Read64(p + 8 * l));
+            p += 32;
+        } while (p <= limit);
+
+        hash = RotateLeft64(lanes[0], 1) + RotateLeft64(lanes[1], 7) + RotateLeft64(lanes[2], 12) + RotateLeft64(lanes[3], 18);
+        for (int l = 0; l < 4; l++) hash = MergeRound64(hash, lanes[l]);
+    } else {
+        hash = seed + PRIME64_5;
+    }
+
+    hash += (uint64_t)length;
+
+    while (p + 8 <= end) {
+        hash ^= Round64(0, Read64(p));
+        hash = RotateLeft64(hash, 27) * PRIME64_1 + PRIME64_4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        hash ^= (uint64_t)Read32(p) * PRIME64_1;
+        hash = RotateLeft64(hash, 23) * PRIME64_2 + PRIME64_3;
+        p += 4;
+    }
+    while (p < end) {
+        hash ^= (*p) * PRIME64_5;
+        hash = RotateLeft64(hash, 11) * PRIME64_1;
+        p++;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+//==================================================================================
+// Hash do estado completo das bolas. Ball não tem bytes de preenchimento,
+// então o vetor pode ser hasheado diretamente como memória.
+//==================================================================================
+uint64_t HashBallState(const Ball balls[], int numBalls) {
+    return HashBytes64(balls, sizeof(Ball) * (size_t)numBalls, 0);
+}
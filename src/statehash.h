@@ -0,0 +1,15 @@
+#ifndef STATEHASH_H
+#define STATEHASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sim.h"
+
+// Hash de 64 bits no estilo xxHash64 (quatro acumuladores independentes
+// sobre blocos de 32 bytes). Dois estados com o mesmo hash são, na prática,
+// idênticos bit a bit: serve para confirmar que caminhos otimizados ou
+// paralelos reproduzem a trajetória de referência.
+uint64_t HashBytes64(const void *data, size_t length, uint64_t seed);
+uint64_t HashBallState(const Ball balls[], int numBalls);
+
+#endif
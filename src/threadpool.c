@@ -0,0 +1,152 @@
+// Como timer.c, não inclui raylib.h: no Windows o número de núcleos vem de
+// windows.h, que conflita com a API do raylib.
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "threadpool.h"
+#include "trace.h"
+#include "timer.h"
+#include "perfcounters.h"
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+static int CountProcessors(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+}
+#else
+#include <unistd.h>
+static int CountProcessors(void) {
+    return (int)sysconf(_SC_NPROCESSORS_ONLN);
+}
+#endif
+
+static struct {
+    bool started;
+    int workers;                       // Inclui a thread que chama ParallelFor.
+    pthread_t threads[THREADPOOL_MAX_WORKERS];
+    int traceIds[THREADPOOL_MAX_WORKERS];
+    pthread_mutex_t mutex;
+    pthread_cond_t startCond;
+    pthread_cond_t doneCond;
+    unsigned long long generation;     // Incrementado a cada ParallelFor.
+    int pending;                       // Threads auxiliares que ainda não terminaram.
+    int ready;                         // Threads auxiliares que já abriram seus contadores.
+    bool stopping;
+    // Tarefa atual.
+    ParallelTask task;
+    void *context;
+    int count;
+    int active;                        // Threads usadas nesta tarefa.
+} pool = { 0 };
+
+static void RunSlice(int worker) {
+    int begin = (int)((long long)pool.count * worker / pool.active);
+    int end = (int)((long long)pool.count * (worker + 1) / pool.active);
+    // Fora de uma captura, nem lê o relógio nem trava o mutex do trace.
+    bool traced = worker > 0 && TraceIsCapturing();
+    uint64_t start = traced ? TimerNowNs() : 0;
+    if (begin < end) pool.task(pool.context, begin, end, worker);
+    if (traced) TraceRecordSpan("Tarefa paralela", pool.traceIds[worker], start, TimerNowNs());
+}
+
+static void *WorkerMain(void *arg) {
+    int worker = (int)(intptr_t)arg;
+    unsigned long long seen = 0;
+    PerfCountersAttachThread();
+    pthread_mutex_lock(&pool.mutex);
+    pool.ready++;
+    pthread_cond_signal(&pool.doneCond);
+    for (;;) {
+        while (!pool.stopping && pool.generation == seen) pthread_cond_wait(&pool.startCond, &pool.mutex);
+        if (pool.stopping) break;
+        seen = pool.generation;
+        if (worker >= pool.active) continue;
+        pthread_mutex_unlock(&pool.mutex);
+
+        RunSlice(worker);
+
+        pthread_mutex_lock(&pool.mutex);
+        if (--pool.pending == 0) pthread_cond_signal(&pool.doneCond);
+    }
+    pthread_mutex_unlock(&pool.mutex);
+    return NULL;
+}
+
+static void StartPool(void) {
+    pool.started = true;
+    pool.workers = CountProcessors();
+    if (pool.workers < 1) pool.workers = 1;
+    if (pool.workers > THREADPOOL_MAX_WORKERS) pool.workers = THREADPOOL_MAX_WORKERS;
+    pthread_mutex_init(&pool.mutex, NULL);
+    pthread_cond_init(&pool.startCond, NULL);
+    pthread_cond_init(&pool.doneCond, NULL);
+
+    pool.traceIds[0] = TRACE_MAIN_THREAD;
+    for (int w = 1; w < pool.workers; w++) {
+        pool.traceIds[w] = TraceRegisterThread("trabalhador");
+        if (pthread_create(&pool.threads[w], NULL, WorkerMain, (void *)(intptr_t)w) != 0) {
+            pool.workers = w;   // Segue com as threads que conseguiu criar.
+            break;
+        }
+    }
+
+    // Espera todas abrirem seus contadores de hardware: as leituras na thread
+    // principal percorrem os grupos abertos sem trava.
+    pthread_mutex_lock(&pool.mutex);
+    while (pool.ready < pool.workers - 1) pthread_cond_wait(&pool.doneCond, &pool.mutex);
+    pthread_mutex_unlock(&pool.mutex);
+}
+
+int ThreadPoolWorkers(void) {
+    if (!pool.started) StartPool();
+    return pool.workers;
+}
+
+void ParallelFor(int count, int minPerWorker, ParallelTask task, void *context) {
+    if (count <= 0) return;
+    if (!pool.started) StartPool();
+
+    int active = (minPerWorker > 0) ? count / minPerWorker : count;
+    if (active > pool.workers) active = pool.workers;
+    if (active <= 1) {
+        task(context, 0, count, 0);
+        return;
+    }
+
+    pthread_mutex_lock(&pool.mutex);
+    pool.task = task;
+    pool.context = context;
+    pool.count = count;
+    pool.active = active;
+    pool.pending = active - 1;
+    pool.generation++;
+    pthread_cond_broadcast(&pool.startCond);
+    pthread_mutex_unlock(&pool.mutex);
+
+    RunSlice(0);
+
+    pthread_mutex_lock(&pool.mutex);
+    while (pool.pending > 0) pthread_cond_wait(&pool.doneCond, &pool.mutex);
+    pthread_mutex_unlock(&pool.mutex);
+}
+
+void ThreadPoolShutdown(void) {
+    if (!pool.started) return;
+    pthread_mutex_lock(&pool.mutex);
+    pool.stopping = true;
+    pthread_cond_broadcast(&pool.startCond);
+    pthread_mutex_unlock(&pool.mutex);
+    for (int w = 1; w < pool.workers; w++) pthread_join(pool.threads[w], NULL);
+    pthread_mutex_destroy(&pool.mutex);
+    pthread_cond_destroy(&pool.startCond);
+    pthread_cond_destroy(&pool.doneCond);
+    pool.started = false;
+    pool.stopping = false;
+    pool.ready = 0;
+}
@@ -0,0 +1,20 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+// --- Laços paralelos ---
+// Um conjunto fixo de threads (uma por núcleo, até THREADPOOL_MAX_WORKERS,
+// contando a thread que chama) criado no primeiro uso. ParallelFor divide
+// [0, count) em um intervalo contíguo por thread, roda a tarefa em todos e
+// só retorna quando todos terminam. 'worker' vai de 0 a ThreadPoolWorkers()-1
+// e serve para indexar dados privados de cada thread.
+#define THREADPOOL_MAX_WORKERS 32
+
+typedef void (*ParallelTask)(void *context, int begin, int end, int worker);
+
+int ThreadPoolWorkers(void);
+// Com menos de 'minPerWorker' itens por thread, usa menos threads (ou só a
+// que chamou).
+void ParallelFor(int count, int minPerWorker, ParallelTask task, void *context);
+void ThreadPoolShutdown(void);
+
+#endif
@@ -0,0 +1,30 @@
+// Este arquivo não inclui raylib.h de propósito: windows.h conflita com
+// vários nomes da API do raylib (Rectangle, CloseWindow, DrawText...).
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "timer.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+
+uint64_t TimerNowNs(void) {
+    static LARGE_INTEGER frequency = { 0 };
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    // Divide em duas partes para não estourar 64 bits em máquinas ligadas há muito tempo.
+    uint64_t seconds = (uint64_t)(counter.QuadPart / frequency.QuadPart);
+    uint64_t remainder = (uint64_t)(counter.QuadPart % frequency.QuadPart);
+    return seconds * 1000000000ULL + remainder * 1000000000ULL / (uint64_t)frequency.QuadPart;
+}
+#else
+#include <time.h>
+
+uint64_t TimerNowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+#endif
@@ -0,0 +1,11 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+
+// Relógio monotônico de alta resolução, em nanossegundos. Não depende da
+// janela do raylib (GetTime só funciona depois de InitWindow), então pode ser
+// usado nos benchmarks e em execuções sem janela.
+uint64_t TimerNowNs(void);
+
+#endif
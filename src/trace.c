@@ -0,0 +1,189 @@
+#include "raylib.h"
+#include "trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+// Um span completo (evento "X"). O nome precisa ser uma string estática,
+// já que só o ponteiro é guardado até a escrita do arquivo.
+typedef struct TraceEvent {
+    const char *name;
+    int threadId;
+    uint64_t startNs;
+    uint64_t endNs;
+} TraceEvent;
+
+// Conjunto de eventos de uma captura; ao terminar, passa a pertencer à
+// thread de escrita, que o libera.
+typedef struct TraceCapture {
+    TraceEvent *events;
+    int count;
+    int capacity;
+    uint64_t originNs;
+    char fileName[64];
+    const char *threadNames[TRACE_MAX_THREADS];
+} TraceCapture;
+
+static pthread_mutex_t traceMutex = PTHREAD_MUTEX_INITIALIZER;
+static TraceCapture *activeCapture = NULL;
+// Espelho de 'activeCapture != NULL' que qualquer thread pode ler sem o
+// mutex. Só é escrito com o mutex travado; a leitura usa os atômicos do
+// GCC/Clang, já que o projeto compila como C99 (sem <stdatomic.h>).
+static int capturing = 0;
+static int framesRemaining = 0;
+static const char *threadNames[TRACE_MAX_THREADS] = { "principal" };
+static int nextThreadId = TRACE_MAIN_THREAD + 1;
+
+static pthread_t writerThread;
+static bool writerRunning = false;
+
+//==================================================================================
+// Começa a gravar os próximos 'frames' quadros. Ignorado se já houver uma
+// captura em andamento.
+//==================================================================================
+void TraceStartCapture(int frames) {
+    if (frames <= 0) return;
+    pthread_mutex_lock(&traceMutex);
+    if (activeCapture == NULL) {
+        TraceCapture *capture = (TraceCapture *)calloc(1, sizeof(TraceCapture));
+        if (capture != NULL) {
+            time_t now = time(NULL);
+            strftime(capture->fileName, sizeof(capture->fileName), "trace_%Y%m%d_%H%M%S.json", localtime(&now));
+            activeCapture = capture;
+            framesRemaining = frames;
+            __atomic_store_n(&capturing, 1, __ATOMIC_RELEASE);
+        }
+    }
+    pthread_mutex_unlock(&traceMutex);
+}
+
+bool TraceIsCapturing(void) {
+    return __atomic_load_n(&capturing, __ATOMIC_ACQUIRE) != 0;
+}
+
+//==================================================================================
+// Registra um span. Pode ser chamada de qualquer thread.
+//==================================================================================
+void TraceRecordSpan(const char *name, int threadId, uint64_t startNs, uint64_t endNs) {
+    pthread_mutex_lock(&traceMutex);
+    TraceCapture *capture = activeCapture;
+    if (capture != NULL) {
+        if (capture->count == capture->capacity) {
+            int newCapacity = capture->capacity ? capture->capacity * 2 : 4096;
+            TraceEvent *events = (TraceEvent *)realloc(capture->events, sizeof(TraceEvent) * newCapacity);
+            if (events == NULL) {
+                pthread_mutex_unlock(&traceMutex);
+                return;
+            }
+            capture->events = events;
+            capture->capacity = newCapacity;
+        }
+        if (capture->originNs == 0 || startNs < capture->originNs) capture->originNs = startNs;
+        capture->events[capture->count++] = (TraceEvent){ name, threadId, startNs, endNs };
+    }
+    pthread_mutex_unlock(&traceMutex);
+}
+
+void TraceSetThreadName(int threadId, const char *name) {
+    if (threadId < 0 || threadId >= TRACE_MAX_THREADS) return;
+    pthread_mutex_lock(&traceMutex);
+    threadNames[threadId] = name;
+    pthread_mutex_unlock(&traceMutex);
+}
+
+//==================================================================================
+// Reserva um identificador para uma thread auxiliar e registra seu nome.
+// Passado o limite, as threads extras passam a compartilhar o último índice.
+//==================================================================================
+int TraceRegisterThread(const char *name) {
+    pthread_mutex_lock(&traceMutex);
+    int threadId = (nextThreadId < TRACE_MAX_THREADS) ? nextThreadId++ : TRACE_MAX_THREADS - 1;
+    threadNames[threadId] = name;
+    pthread_mutex_unlock(&traceMutex);
+    return threadId;
+}
+
+//==================================================================================
+// Thread de escrita: serializa a captura em JSON e libera a memória.
+//==================================================================================
+static void *TraceWriterMain(void *arg) {
+    TraceCapture *capture = (TraceCapture *)arg;
+    FILE *file = fopen(capture->fileName, "w");
+
+    if (file != NULL) {
+        fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+        fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"simulador\"}}");
+        for (int t = 0; t < TRACE_MAX_THREADS; t++) {
+            if (capture->threadNames[t] == NULL) continue;
+            fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                    t, capture->threadNames[t]);
+        }
+        for (int i = 0; i < capture->count; i++) {
+            const TraceEvent *e = &capture->events[i];
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    e->name, e->threadId, (e->startNs - capture->originNs) / 1000.0, (e->endNs - e->startNs) / 1000.0);
+        }
+        fprintf(file, "\n]}\n");
+        fclose(file);
+        TraceLog(LOG_INFO, "TRACE: %d eventos gravados em %s", capture->count, capture->fileName);
+    } else {
+        TraceLog(LOG_WARNING, "TRACE: não foi possível criar %s", capture->fileName);
+    }
+
+    free(capture->events);
+    free(capture);
+    return NULL;
+}
+
+//==================================================================================
+// Entrega uma captura encerrada para a thread de escrita. Só uma escrita
+// acontece por vez; capturas seguidas esperam a anterior terminar.
+//==================================================================================
+static void TraceSubmit(TraceCapture *finished) {
+    if (writerRunning) pthread_join(writerThread, NULL);
+    writerRunning = (pthread_create(&writerThread, NULL, TraceWriterMain, finished) == 0);
+    if (!writerRunning) TraceWriterMain(finished);
+}
+
+//==================================================================================
+// Tira a captura ativa do alcance das demais threads. Chamada com o mutex travado.
+//==================================================================================
+static TraceCapture *TraceDetachCapture(void) {
+    TraceCapture *capture = activeCapture;
+    if (capture != NULL) memcpy(capture->threadNames, threadNames, sizeof(threadNames));
+    activeCapture = NULL;
+    __atomic_store_n(&capturing, 0, __ATOMIC_RELEASE);
+    return capture;
+}
+
+//==================================================================================
+// Chamada uma vez por quadro na thread principal; encerra a captura quando a
+// janela de quadros pedida termina.
+//==================================================================================
+void TraceFrame(void) {
+    TraceCapture *finished = NULL;
+
+    pthread_mutex_lock(&traceMutex);
+    if (activeCapture != NULL && --framesRemaining <= 0) finished = TraceDetachCapture();
+    pthread_mutex_unlock(&traceMutex);
+
+    if (finished != NULL) TraceSubmit(finished);
+}
+
+//==================================================================================
+// Grava o que já foi capturado (se houver captura em andamento) e espera a
+// escrita pendente terminar.
+//==================================================================================
+void TraceShutdown(void) {
+    pthread_mutex_lock(&traceMutex);
+    TraceCapture *finished = TraceDetachCapture();
+    pthread_mutex_unlock(&traceMutex);
+
+    if (finished != NULL) TraceSubmit(finished);
+    if (writerRunning) {
+        pthread_join(writerThread, NULL);
+        writerRunning = false;
+    }
+}
@@ -0,0 +1,27 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// --- Exportação de trace ---
+// Grava uma janela de quadros como JSON no formato "trace event" do Chrome
+// (abre no Perfetto ou em chrome://tracing). Os spans vêm dos mesmos pontos
+// instrumentados pelo profiler; a escrita do arquivo acontece numa thread
+// separada para não travar o loop.
+
+// Identificador da thread principal nos eventos; threads auxiliares usam
+// índices a partir de 1.
+#define TRACE_MAIN_THREAD 0
+#define TRACE_MAX_THREADS 64
+
+void TraceStartCapture(int frames);
+// Pode ser chamada de qualquer thread, sem travar o mutex do trace.
+bool TraceIsCapturing(void);
+void TraceRecordSpan(const char *name, int threadId, uint64_t startNs, uint64_t endNs);
+void TraceSetThreadName(int threadId, const char *name);
+int TraceRegisterThread(const char *name);
+void TraceFrame(void);
+void TraceShutdown(void);
+
+#endif
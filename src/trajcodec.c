@@ -0,0 +1,422 @@
+#include "trajcodec.h"
+#include "trajectory.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// --- rANS de ordem 0 ---
+// Estado de 32 bits, renormalização por byte e probabilidades em 12 bits.
+#define RANS_PROB_BITS 12
+#define RANS_PROB_SCALE (1u << RANS_PROB_BITS)
+#define RANS_LOWER_BOUND (1u << 23)
+
+#define FRAME_HEADER_SIZE 24
+#define BLOCK_HEADER_SIZE 12
+#define FREQ_TABLE_SIZE (256 * 2)
+#define INDEX_ENTRY_SIZE 24
+#define TRAILER_SIZE 16
+
+enum { BLOCK_STORED = 0, BLOCK_RANS = 1 };
+
+static void PutU16(unsigned char *p, uint16_t v) { p[0] = (unsigned char)v; p[1] = (unsigned char)(v >> 8); }
+static void PutU32(unsigned char *p, uint32_t v) { for (int i = 0; i < 4; i++) p[i] = (unsigned char)(v >> (8 * i)); }
+static void PutU64(unsigned char *p, uint64_t v) { for (int i = 0; i < 8; i++) p[i] = (unsigned char)(v >> (8 * i)); }
+static uint16_t GetU16(const unsigned char *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+static uint32_t GetU32(const unsigned char *p) { return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24); }
+static uint64_t GetU64(const unsigned char *p) { return (uint64_t)GetU32(p) | ((uint64_t)GetU32(p + 4) << 32); }
+
+static bool EnsureCapacity(unsigned char **buffer, size_t *capacity, size_t needed) {
+    if (needed <= *capacity) return true;
+    unsigned char *grown = (unsigned char *)realloc(*buffer, needed);
+    if (grown == NULL) return false;
+    *buffer = grown;
+    *capacity = needed;
+    return true;
+}
+
+//==================================================================================
+// Normaliza as contagens de símbolos para somarem RANS_PROB_SCALE, mantendo
+// frequência mínima 1 para todo símbolo presente.
+//==================================================================================
+static void NormalizeFrequencies(const uint32_t counts[256], size_t total, uint32_t freqs[256]) {
+    uint32_t sum = 0;
+    for (int s = 0; s < 256; s++) {
+        freqs[s] = 0;
+        if (counts[s] == 0) continue;
+        freqs[s] = (uint32_t)((uint64_t)counts[s] * RANS_PROB_SCALE / total);
+        if (freqs[s] == 0) freqs[s] = 1;
+        sum += freqs[s];
+    }
+
+    // Ajusta a diferença no símbolo mais frequente (ou, se faltar margem, nos seguintes).
+    while (sum != RANS_PROB_SCALE) {
+        int largest = 0;
+        for (int s = 1; s < 256; s++) if (freqs[s] > freqs[largest]) largest = s;
+        if (sum < RANS_PROB_SCALE) {
+            freqs[largest] += RANS_PROB_SCALE - sum;
+            sum = RANS_PROB_SCALE;
+        } else {
+            uint32_t excess = sum - RANS_PROB_SCALE;
+            uint32_t take = (freqs[largest] - 1 < excess) ? freqs[largest] - 1 : excess;
+            freqs[largest] -= take;
+            sum -= take;
+        }
+    }
+}
+
+//==================================================================================
+// Comprime um bloco com rANS. Escreve a tabela de frequências e os dados em
+// 'out' e retorna o tamanho, ou 0 se não couber em 'limit' bytes (nesse caso
+// o bloco é guardado sem compressão).
+//==================================================================================
+static size_t RansEncodeBlock(const unsigned char *in, size_t length, unsigned char *out, size_t limit, unsigned char *work) {
+    uint32_t counts[256] = { 0 };
+    uint32_t freqs[256];
+    uint32_t cumulative[256];
+
+    for (size_t i = 0; i < length; i++) counts[in[i]]++;
+    NormalizeFrequencies(counts, length, freqs);
+    uint32_t running = 0;
+    for (int s = 0; s < 256; s++) {
+        cumulative[s] = running;
+        running += freqs[s];
+    }
+
+    // O rANS codifica de trás para frente; 'work' recebe a saída a partir do fim.
+    size_t workSize = 2 * length + 16;
+    unsigned char *ptr = work + workSize;
+    uint32_t state = RANS_LOWER_BOUND;
+    for (size_t i = length; i > 0; i--) {
+        unsigned char s = in[i - 1];
+        uint32_t maxState = ((RANS_LOWER_BOUND >> RANS_PROB_BITS) << 8) * freqs[s];
+        while (state >= maxState) {
+            *--ptr = (unsigned char)(state & 0xFF);
+            state >>= 8;
+        }
+        state = ((state / freqs[s]) << RANS_PROB_BITS) + (state % freqs[s]) + cumulative[s];
+    }
+    ptr -= 4;
+    PutU32(ptr, state);
+
+    size_t encoded = (size_t)(work + workSize - ptr);
+    if (FREQ_TABLE_SIZE + encoded >= limit) return 0;
+    for (int s = 0; s < 256; s++) PutU16(out + 2 * s, (uint16_t)freqs[s]);
+    memcpy(out + FREQ_TABLE_SIZE, ptr, encoded);
+    return FREQ_TABLE_SIZE + encoded;
+}
+
+static bool RansDecodeBlock(const unsigned char *in, size_t storedSize, unsigned char *out, size_t length) {
+    uint32_t freqs[256];
+    uint32_t cumulative[256];
+    unsigned char slotSymbol[RANS_PROB_SCALE];
+
+    if (storedSize < FREQ_TABLE_SIZE + 4) return false;
+    uint32_t running = 0;
+    for (int s = 0; s < 256; s++) {
+        freqs[s] = GetU16(in + 2 * s);
+        cumulative[s] = running;
+        if (running + freqs[s] > RANS_PROB_SCALE) return false;
+        memset(slotSymbol + running, s, freqs[s]);
+        running += freqs[s];
+    }
+    if (running != RANS_PROB_SCALE) return false;
+
+    const unsigned char *ptr = in + FREQ_TABLE_SIZE;
+    const unsigned char *end = in + storedSize;
+    uint32_t state = GetU32(ptr);
+    ptr += 4;
+    for (size_t i = 0; i < length; i++) {
+        uint32_t slot = state & (RANS_PROB_SCALE - 1);
+        unsigned char s = slotSymbol[slot];
+        out[i] = s;
+        state = freqs[s] * (state >> RANS_PROB_BITS) + slot - cumulative[s];
+        while (state < RANS_LOWER_BOUND) {
+            if (ptr >= end) return false;
+            state = (state << 8) | *ptr++;
+        }
+    }
+    return true;
+}
+
+static size_t PutVarint(unsigned char *p, uint32_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        p[n++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    p[n++] = (unsigned char)value;
+    return n;
+}
+
+static bool GetVarint(const unsigned char **p, const unsigned char *end, uint32_t *value) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (*p >= end) return false;
+        unsigned char byte = *(*p)++;
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+static uint32_t ZigZag(int32_t value) { return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31); }
+static int32_t UnZigZag(uint32_t value) { return (int32_t)(value >> 1) ^ -(int32_t)(value & 1); }
+
+// Com sinal: a separação de sobreposições pode empurrar uma bola um pouco
+// para fora do mundo, e essa posição também precisa ser preservada.
+static uint32_t Quantize(float value, float precision) {
+    double q = (double)value / precision;
+    if (q < INT32_MIN) q = INT32_MIN;
+    if (q > INT32_MAX) q = INT32_MAX;
+    return (uint32_t)(int32_t)llround(q);
+}
+
+//==================================================================================
+// Codificador
+//==================================================================================
+bool DeltaEncoderInit(DeltaEncoder *encoder, float relativePrecision, int keyframeInterval, int width, int height) {
+    memset(encoder, 0, sizeof(*encoder));
+    // O passo de quantização acompanha o maior lado do mundo; o fluxo guarda
+    // o passo já em unidades do mundo, então o leitor não precisa saber disso.
+    float precision = relativePrecision * (float)((width > height) ? width : height);
+    if (!(relativePrecision > 0.0f) || !(precision > 0.0f) ||
+        (double)width / precision > INT32_MAX || (double)height / precision > INT32_MAX) return false;
+    encoder->precision = precision;
+    encoder->keyframeInterval = (keyframeInterval > 0) ? keyframeInterval : 1;
+    encoder->width = width;
+    encoder->height = height;
+    return true;
+}
+
+void DeltaEncoderFree(DeltaEncoder *encoder) {
+    free(encoder->previous);
+    free(encoder->scratch);
+    free(encoder->index);
+    memset(encoder, 0, sizeof(*encoder));
+}
+
+size_t DeltaEncodeStreamHeader(const DeltaEncoder *encoder, unsigned char out[16]) {
+    uint32_t precisionBits;
+    memcpy(&precisionBits, &encoder->precision, sizeof(precisionBits));
+    PutU32(out, precisionBits);
+    PutU32(out + 4, (uint32_t)encoder->width);
+    PutU32(out + 8, (uint32_t)encoder->height);
+    PutU32(out + 12, (uint32_t)encoder->keyframeInterval);
+    return 16;
+}
+
+size_t DeltaEncodeFrame(DeltaEncoder *encoder, uint64_t step, const float *x, const float *y, int numBalls,
+                        uint64_t fileOffset, unsigned char **out, size_t *outCapacity) {
+    bool keyframe = (encoder->framesSinceKeyframe % encoder->keyframeInterval == 0) || numBalls != encoder->previousCount;
+    size_t values = 2 * (size_t)numBalls;
+
+    if (numBalls != encoder->previousCount) {
+        uint32_t *previous = (uint32_t *)realloc(encoder->previous, sizeof(uint32_t) * (values ? values : 1));
+        if (previous == NULL) return 0;
+        encoder->previous = previous;
+        encoder->previousCount = numBalls;
+    }
+    if (!EnsureCapacity(&encoder->scratch, &encoder->scratchCapacity, 5 * values + 1)) return 0;
+    if (encoder->indexCount == encoder->indexCapacity) {
+        int capacity = encoder->indexCapacity ? encoder->indexCapacity * 2 : 1024;
+        DeltaIndexEntry *index = (DeltaIndexEntry *)realloc(encoder->index, sizeof(DeltaIndexEntry) * capacity);
+        if (index == NULL) return 0;
+        encoder->index = index;
+        encoder->indexCapacity = capacity;
+    }
+
+    // Fluxo varint: todos os x, depois todos os y (deltas do mesmo eixo juntos comprimem melhor).
+    size_t rawBytes = 0;
+    for (size_t v = 0; v < values; v++) {
+        uint32_t q = Quantize((v < (size_t)numBalls) ? x[v] : y[v - numBalls], encoder->precision);
+        uint32_t symbol = ZigZag((int32_t)(keyframe ? q : q - encoder->previous[v]));
+        encoder->previous[v] = q;
+        rawBytes += PutVarint(encoder->scratch + rawBytes, symbol);
+    }
+
+    size_t blocks = (rawBytes + DELTA_BLOCK_SIZE - 1) / DELTA_BLOCK_SIZE;
+    size_t worstCase = FRAME_HEADER_SIZE + blocks * BLOCK_HEADER_SIZE + rawBytes;
+    // Área de trabalho do rANS logo após o pior caso da saída.
+    if (!EnsureCapacity(out, outCapacity, worstCase + 2 * DELTA_BLOCK_SIZE + 16)) return 0;
+    unsigned char *work = *out + worstCase;
+
+    size_t written = FRAME_HEADER_SIZE;
+    for (size_t offset = 0; offset < rawBytes; offset += DELTA_BLOCK_SIZE) {
+        size_t length = (rawBytes - offset < DELTA_BLOCK_SIZE) ? rawBytes - offset : DELTA_BLOCK_SIZE;
+        unsigned char *block = *out + written;
+        size_t stored = RansEncodeBlock(encoder->scratch + offset, length, block + BLOCK_HEADER_SIZE, length, work);
+        uint32_t mode = BLOCK_RANS;
+        if (stored == 0) {
+            memcpy(block + BLOCK_HEADER_SIZE, encoder->scratch + offset, length);
+            stored = length;
+            mode = BLOCK_STORED;
+        }
+        PutU32(block, (uint32_t)length);
+        PutU32(block + 4, (uint32_t)stored);
+        PutU32(block + 8, mode);
+        written += BLOCK_HEADER_SIZE + stored;
+    }
+
+    PutU32(*out, (uint32_t)written);
+    PutU32(*out + 4, keyframe ? 1u : 0u);
+    PutU64(*out + 8, step);
+    PutU32(*out + 16, (uint32_t)numBalls);
+    PutU32(*out + 20, (uint32_t)rawBytes);
+
+    encoder->index[encoder->indexCount++] = (DeltaIndexEntry){ step, fileOffset, (uint32_t)numBalls, keyframe ? 1u : 0u };
+    encoder->framesSinceKeyframe = keyframe ? 1 : encoder->framesSinceKeyframe + 1;
+    return written;
+}
+
+size_t DeltaEncodeIndex(const DeltaEncoder *encoder, uint64_t indexOffset, unsigned char **out, size_t *outCapacity) {
+    size_t size = (size_t)encoder->indexCount * INDEX_ENTRY_SIZE + TRAILER_SIZE;
+    if (!EnsureCapacity(out, outCapacity, size)) return 0;
+
+    unsigned char *p = *out;
+    for (int i = 0; i < encoder->indexCount; i++, p += INDEX_ENTRY_SIZE) {
+        PutU64(p, encoder->index[i].step);
+        PutU64(p + 8, encoder->index[i].offset);
+        PutU32(p + 16, encoder->index[i].numBalls);
+        PutU32(p + 20, encoder->index[i].keyframe);
+    }
+    PutU64(p, indexOffset);
+    PutU32(p + 8, (uint32_t)encoder->indexCount);
+    PutU32(p + 12, DELTA_INDEX_MAGIC);
+    return size;
+}
+
+//==================================================================================
+// Leitor: mapeia o arquivo inteiro e decodifica sob demanda.
+//==================================================================================
+bool DeltaReaderOpen(DeltaReader *reader, const char *path) {
+    memset(reader, 0, sizeof(*reader));
+    reader->decodedFrame = -1;
+    if (!MapFileRead(&reader->file, path)) return false;
+
+    const unsigned char *base = (const unsigned char *)reader->file.data;
+    size_t size = reader->file.size;
+    bool valid = size >= sizeof(TrajectoryFileHeader) + 16 + TRAILER_SIZE &&
+                 memcmp(base, TRAJECTORY_MAGIC, sizeof(TRAJECTORY_MAGIC)) == 0 &&
+                 GetU32(base + 12) == TRAJECTORY_DELTA;
+    if (valid) {
+        const unsigned char *stream = base + sizeof(TrajectoryFileHeader);
+        uint32_t precisionBits = GetU32(stream);
+        memcpy(&reader->precision, &precisionBits, sizeof(float));
+        reader->width = (int)GetU32(stream + 4);
+        reader->height = (int)GetU32(stream + 8);
+
+        const unsigned char *trailer = base + size - TRAILER_SIZE;
+        uint64_t indexOffset = GetU64(trailer);
+        reader->frameCount = (int)GetU32(trailer + 8);
+        valid = GetU32(trailer + 12) == DELTA_INDEX_MAGIC && indexOffset <= size - TRAILER_SIZE &&
+                (uint64_t)reader->frameCount * INDEX_ENTRY_SIZE == size - TRAILER_SIZE - indexOffset;
+        reader->index = base + indexOffset;
+    }
+    if (!valid) {
+        UnmapFile(&reader->file);
+        return false;
+    }
+    return true;
+}
+
+void DeltaReaderClose(DeltaReader *reader) {
+    UnmapFile(&reader->file);
+    free(reader->quantized);
+    free(reader->scratch);
+    memset(reader, 0, sizeof(*reader));
+}
+
+int DeltaReaderBallCount(const DeltaReader *reader, int frame) {
+    if (frame < 0 || frame >= reader->frameCount) return 0;
+    return (int)GetU32(reader->index + (size_t)frame * INDEX_ENTRY_SIZE + 16);
+}
+
+//==================================================================================
+// Decodifica um quadro sobre o estado quantizado atual (que precisa ser o do
+// quadro anterior, a menos que este seja um quadro-chave).
+//==================================================================================
+static bool DecodeFrame(DeltaReader *reader, int frame) {
+    const unsigned char *base = (const unsigned char *)reader->file.data;
+    const unsigned char *entry = reader->index + (size_t)frame * INDEX_ENTRY_SIZE;
+    uint64_t offset = GetU64(entry + 8);
+    if (offset + FRAME_HEADER_SIZE > reader->file.size) return false;
+
+    const unsigned char *header = base + offset;
+    uint32_t frameBytes = GetU32(header);
+    bool keyframe = GetU32(header + 4) != 0;
+    int numBalls = (int)GetU32(header + 16);
+    size_t rawBytes = GetU32(header + 20);
+    if (offset + frameBytes > reader->file.size || numBalls < 0) return false;
+    if (!keyframe && numBalls != reader->quantizedCount) return false;
+
+    size_t values = 2 * (size_t)numBalls;
+    if (numBalls != reader->quantizedCount) {
+        uint32_t *quantized = (uint32_t *)realloc(reader->quantized, sizeof(uint32_t) * (values ? values : 1));
+        if (quantized == NULL) return false;
+        reader->quantized = quantized;
+        reader->quantizedCount = numBalls;
+    }
+    if (!EnsureCapacity(&reader->scratch, &reader->scratchCapacity, rawBytes + 1)) return false;
+
+    // Descomprime os blocos no fluxo varint.
+    const unsigned char *p = header + FRAME_HEADER_SIZE;
+    const unsigned char *end = header + frameBytes;
+    size_t decoded = 0;
+    while (decoded < rawBytes) {
+        if (p + BLOCK_HEADER_SIZE > end) return false;
+        size_t length = GetU32(p);
+        size_t stored = GetU32(p + 4);
+        uint32_t mode = GetU32(p + 8);
+        p += BLOCK_HEADER_SIZE;
+        if (p + stored > end || decoded + length > rawBytes) return false;
+        if (mode == BLOCK_STORED) {
+            if (stored != length) return false;
+            memcpy(reader->scratch + decoded, p, length);
+        } else if (!RansDecodeBlock(p, stored, reader->scratch + decoded, length)) {
+            return false;
+        }
+        p += stored;
+        decoded += length;
+    }
+
+    const unsigned char *stream = reader->scratch;
+    const unsigned char *streamEnd = reader->scratch + rawBytes;
+    for (size_t v = 0; v < values; v++) {
+        uint32_t symbol;
+        if (!GetVarint(&stream, streamEnd, &symbol)) return false;
+        uint32_t value = (uint32_t)UnZigZag(symbol);
+        reader->quantized[v] = keyframe ? value : reader->quantized[v] + value;
+    }
+    reader->decodedFrame = frame;
+    return true;
+}
+
+bool DeltaReaderSeek(DeltaReader *reader, int frame, float *x, float *y, int maxBalls, int *numBalls, uint64_t *step) {
+    if (frame < 0 || frame >= reader->frameCount) return false;
+
+    // Parte do quadro-chave mais próximo, ou do estado já decodificado se ele
+    // estiver entre esse quadro-chave e o quadro pedido.
+    int keyframe = frame;
+    while (keyframe > 0 && GetU32(reader->index + (size_t)keyframe * INDEX_ENTRY_SIZE + 20) == 0) keyframe--;
+    int start = keyframe;
+    if (reader->decodedFrame >= keyframe && reader->decodedFrame <= frame) start = reader->decodedFrame + 1;
+    for (int f = start; f <= frame; f++) {
+        if (!DecodeFrame(reader, f)) {
+            reader->decodedFrame = -1;
+            return false;
+        }
+    }
+
+    int count = reader->quantizedCount;
+    if (count > maxBalls) return false;
+    for (int i = 0; i < count; i++) {
+        x[i] = (int32_t)reader->quantized[i] * reader->precision;
+        y[i] = (int32_t)reader->quantized[count + i] * reader->precision;
+    }
+    *numBalls = count;
+    *step = GetU64(reader->index + (size_t)frame * INDEX_ENTRY_SIZE);
+    return true;
+}
@@ -0,0 +1,79 @@
+#ifndef TRAJCODEC_H
+#define TRAJCODEC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "mapped_file.h"
+
+// --- Formato compacto de trajetória (delta) ---
+// As posições são quantizadas com uma precisão fixa, dada como fração do
+// maior lado do mundo (inteiros de 32 bits com sinal), e codificadas como
+// diferença em relação ao quadro anterior (zigzag + varint), com um
+// quadro-chave absoluto a cada N quadros. O fluxo de bytes de cada quadro é
+// comprimido em blocos por um codificador rANS de ordem 0. No fim do arquivo fica um índice com o deslocamento de todos os
+// quadros, que o leitor usa para pular até o quadro-chave mais próximo.
+// Só as posições entram neste formato; velocidades podem ser obtidas por
+// diferença finita ou gravadas no formato RAW.
+
+// Tamanho máximo (sem compressão) de cada bloco codificado.
+#define DELTA_BLOCK_SIZE (1 << 16)
+#define DELTA_INDEX_MAGIC 0x58444954u   // "TIDX"
+
+typedef struct DeltaIndexEntry {
+    uint64_t step;
+    uint64_t offset;
+    uint32_t numBalls;
+    uint32_t keyframe;
+} DeltaIndexEntry;
+
+typedef struct DeltaEncoder {
+    float precision;           // Passo de quantização, em unidades do mundo.
+    int width;
+    int height;
+    int keyframeInterval;
+    uint32_t *previous;        // Posições quantizadas do quadro anterior (x[] seguido de y[]).
+    int previousCount;
+    int framesSinceKeyframe;
+    unsigned char *scratch;    // Fluxo varint do quadro atual.
+    size_t scratchCapacity;
+    DeltaIndexEntry *index;
+    int indexCount;
+    int indexCapacity;
+} DeltaEncoder;
+
+typedef struct DeltaReader {
+    MappedFile file;
+    float precision;
+    int width;
+    int height;
+    const unsigned char *index;
+    int frameCount;
+    uint32_t *quantized;       // Estado decodificado mais recente (x[] seguido de y[]).
+    int quantizedCount;
+    int decodedFrame;          // Quadro em 'quantized', ou -1.
+    unsigned char *scratch;
+    size_t scratchCapacity;
+} DeltaReader;
+
+// 'relativePrecision' é o passo de quantização como fração de max(width, height).
+bool DeltaEncoderInit(DeltaEncoder *encoder, float relativePrecision, int keyframeInterval, int width, int height);
+void DeltaEncoderFree(DeltaEncoder *encoder);
+// Cabeçalho do fluxo, gravado logo após o cabeçalho do arquivo.
+size_t DeltaEncodeStreamHeader(const DeltaEncoder *encoder, unsigned char out[16]);
+// Codifica um quadro para 'out' (realocado se preciso) e o registra no
+// índice com o deslocamento dado. Retorna o tamanho em bytes (0 em erro).
+size_t DeltaEncodeFrame(DeltaEncoder *encoder, uint64_t step, const float *x, const float *y, int numBalls,
+                        uint64_t fileOffset, unsigned char **out, size_t *outCapacity);
+// Codifica o índice e o rodapé que aponta para ele.
+size_t DeltaEncodeIndex(const DeltaEncoder *encoder, uint64_t indexOffset, unsigned char **out, size_t *outCapacity);
+
+bool DeltaReaderOpen(DeltaReader *reader, const char *path);
+void DeltaReaderClose(DeltaReader *reader);
+// Número de bolas do quadro, lido do índice sem decodificar nada.
+int DeltaReaderBallCount(const DeltaReader *reader, int frame);
+// Decodifica o quadro pedido (a partir do quadro-chave mais próximo) e
+// preenche as posições em x[] e y[], que devem ter espaço para 'maxBalls'.
+bool DeltaReaderSeek(DeltaReader *reader, int frame, float *x, float *y, int maxBalls, int *numBalls, uint64_t *step);
+
+#endif
@@ -0,0 +1,406 @@
+#if defined(TRAJECTORY_IO_URING) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include "trajectory.h"
+#include "trajcodec.h"
+#include "trace.h"
+#include "timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(TRAJECTORY_IO_URING)
+#include <fcntl.h>
+#include <unistd.h>
+#include <liburing.h>
+#endif
+
+// Buffer de um quadro: cabeçalho seguido dos quatro vetores, contíguo para
+// poder ser escrito com uma única chamada. No formato DELTA, 'encoded'
+// guarda a versão codificada, que precisa viver até a escrita terminar.
+typedef struct FrameBuffer {
+    unsigned char *data;
+    size_t capacity;
+    size_t used;
+    unsigned char *encoded;
+    size_t encodedCapacity;
+    const unsigned char *payload;   // O que de fato vai para o arquivo.
+    size_t payloadSize;
+} FrameBuffer;
+
+// Estado do gravador. Os índices dos buffers circulam entre a pilha de
+// livres (do lado do passo) e a fila de prontos (do lado da escrita).
+static struct {
+    bool active;
+    TrajectoryFormat format;
+    DeltaEncoder encoder;
+    uint64_t offset;   // Posição do próximo byte no arquivo.
+    int every;
+    int bufferCount;
+    FrameBuffer *buffers;
+    int *freeStack;
+    int freeCount;
+    int *readyQueue;
+    int readyHead;
+    int readyCount;
+    bool stopping;
+    bool failed;
+    pthread_mutex_t mutex;
+    pthread_cond_t freeCond;
+    pthread_cond_t readyCond;
+    pthread_t thread;
+    TrajectoryStats stats;
+#if defined(TRAJECTORY_IO_URING)
+    int fd;
+    struct io_uring ring;
+#else
+    FILE *file;
+#endif
+} writer;
+
+//==================================================================================
+// Devolve um buffer à pilha de livres e acorda o passo, se estiver esperando.
+//==================================================================================
+static void ReleaseBuffer(int index, size_t bytes) {
+    pthread_mutex_lock(&writer.mutex);
+    writer.freeStack[writer.freeCount++] = index;
+    writer.stats.framesWritten++;
+    writer.stats.bytesWritten += (long long)bytes;
+    pthread_cond_signal(&writer.freeCond);
+    pthread_mutex_unlock(&writer.mutex);
+}
+
+//==================================================================================
+// Tira o próximo buffer pronto da fila, ou retorna -1 se ela estiver vazia.
+// Chamada com o mutex travado.
+//==================================================================================
+static int PopReady(void) {
+    if (writer.readyCount == 0) return -1;
+    int index = writer.readyQueue[writer.readyHead];
+    writer.readyHead = (writer.readyHead + 1) % writer.bufferCount;
+    writer.readyCount--;
+    return index;
+}
+
+static void ReportWriteError(void) {
+    if (!writer.failed) fprintf(stderr, "Falha ao gravar a trajetória; os quadros seguintes serão descartados\n");
+    writer.failed = true;
+}
+
+//==================================================================================
+// Define o que será escrito para um quadro: o próprio buffer (RAW) ou sua
+// versão codificada (DELTA). Reserva o trecho do arquivo que ele ocupará.
+// Só a thread de escrita chama, sempre na ordem dos quadros.
+//==================================================================================
+static void PrepareFrame(FrameBuffer *buffer) {
+    buffer->payload = buffer->data;
+    buffer->payloadSize = buffer->used;
+
+    if (writer.format == TRAJECTORY_DELTA) {
+        TrajectoryFrameHeader header;
+        memcpy(&header, buffer->data, sizeof(header));
+        const float *x = (const float *)(buffer->data + sizeof(header));
+        const float *y = x + header.numBalls;
+        size_t size = DeltaEncodeFrame(&writer.encoder, header.step, x, y, (int)header.numBalls, writer.offset,
+                                       &buffer->encoded, &buffer->encodedCapacity);
+        if (size == 0) ReportWriteError();
+        buffer->payload = buffer->encoded;
+        buffer->payloadSize = size;
+    }
+    writer.offset += buffer->payloadSize;
+}
+
+#if defined(TRAJECTORY_IO_URING)
+//==================================================================================
+// Thread de escrita com io_uring: envia todos os quadros prontos de uma vez
+// e devolve cada buffer quando a escrita correspondente termina.
+//==================================================================================
+static void *TrajectoryWriterMain(void *arg) {
+    int threadId = TraceRegisterThread("trajetória");
+    int inflight = 0;
+    (void)arg;
+
+    for (;;) {
+        int taken[64];
+        int takenCount = 0;
+
+        pthread_mutex_lock(&writer.mutex);
+        while (writer.readyCount == 0 && inflight == 0 && !writer.stopping) pthread_cond_wait(&writer.readyCond, &writer.mutex);
+        while (takenCount < 64 && (taken[takenCount] = PopReady()) != -1) takenCount++;
+        bool finished = writer.stopping && writer.readyCount == 0 && takenCount == 0 && inflight == 0;
+        pthread_mutex_unlock(&writer.mutex);
+        if (finished) break;
+
+        uint64_t start = TimerNowNs();
+        for (int t = 0; t < takenCount; t++) {
+            FrameBuffer *buffer = &writer.buffers[taken[t]];
+            uint64_t offset = writer.offset;
+            PrepareFrame(buffer);
+            struct io_uring_sqe *sqe = io_uring_get_sqe(&writer.ring);
+            if (sqe == NULL) {
+                io_uring_submit(&writer.ring);
+                sqe = io_uring_get_sqe(&writer.ring);
+            }
+            io_uring_prep_write(sqe, writer.fd, buffer->payload, (unsigned)buffer->payloadSize, offset);
+            io_uring_sqe_set_data(sqe, (void *)(intptr_t)taken[t]);
+            inflight++;
+        }
+        if (takenCount > 0) io_uring_submit(&writer.ring);
+
+        // Sem quadros novos, espera ao menos uma conclusão; depois colhe as que já terminaram.
+        struct io_uring_cqe *cqe;
+        bool waitOne = (takenCount == 0 && inflight > 0);
+        while (inflight > 0 && ((waitOne && io_uring_wait_cqe(&writer.ring, &cqe) == 0) || io_uring_peek_cqe(&writer.ring, &cqe) == 0)) {
+            int index = (int)(intptr_t)io_uring_cqe_get_data(cqe);
+            size_t bytes = writer.buffers[index].payloadSize;
+            if (cqe->res < 0 || (size_t)cqe->res != bytes) ReportWriteError();
+            io_uring_cqe_seen(&writer.ring, cqe);
+            inflight--;
+            waitOne = false;
+            ReleaseBuffer(index, bytes);
+        }
+        if (takenCount > 0) TraceRecordSpan("Escrita da trajetória", threadId, start, TimerNowNs());
+    }
+    return NULL;
+}
+
+static bool OpenOutput(const char *path) {
+    writer.fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (writer.fd < 0) return false;
+    if (io_uring_queue_init((unsigned)writer.bufferCount, &writer.ring, 0) < 0) {
+        close(writer.fd);
+        return false;
+    }
+    return true;
+}
+
+static bool WriteOutput(const void *data, size_t size) {
+    ssize_t written = pwrite(writer.fd, data, size, (off_t)writer.offset);
+    writer.offset += size;
+    return written == (ssize_t)size;
+}
+
+static void CloseOutput(void) {
+    io_uring_queue_exit(&writer.ring);
+    close(writer.fd);
+}
+#else
+//==================================================================================
+// Thread de escrita com stdio: grava os quadros prontos em ordem e devolve
+// cada buffer assim que ele vai para o arquivo.
+//==================================================================================
+static void *TrajectoryWriterMain(void *arg) {
+    int threadId = TraceRegisterThread("trajetória");
+    (void)arg;
+
+    for (;;) {
+        pthread_mutex_lock(&writer.mutex);
+        while (writer.readyCount == 0 && !writer.stopping) pthread_cond_wait(&writer.readyCond, &writer.mutex);
+        int index = PopReady();
+        pthread_mutex_unlock(&writer.mutex);
+        if (index == -1) break;
+
+        FrameBuffer *buffer = &writer.buffers[index];
+        uint64_t start = TimerNowNs();
+        PrepareFrame(buffer);
+        if (!writer.failed && fwrite(buffer->payload, 1, buffer->payloadSize, writer.file) != buffer->payloadSize) ReportWriteError();
+        TraceRecordSpan("Escrita da trajetória", threadId, start, TimerNowNs());
+        ReleaseBuffer(index, buffer->payloadSize);
+    }
+    return NULL;
+}
+
+static bool OpenOutput(const char *path) {
+    writer.file = fopen(path, "wb");
+    return writer.file != NULL;
+}
+
+static bool WriteOutput(const void *data, size_t size) {
+    writer.offset += size;
+    return fwrite(data, 1, size, writer.file) == size;
+}
+
+static void CloseOutput(void) {
+    if (fclose(writer.file) != 0) ReportWriteError();
+}
+#endif
+
+//==================================================================================
+// Abre o arquivo, aloca o conjunto de buffers e inicia a thread de escrita.
+//==================================================================================
+bool TrajectoryStart(const TrajectoryOptions *options) {
+    if (writer.active) return false;
+    memset(&writer, 0, sizeof(writer));
+    writer.format = options->format;
+    writer.every = (options->every > 0) ? options->every : 1;
+    writer.bufferCount = (options->bufferCount >= 2) ? options->bufferCount : 2;
+
+    if (writer.format == TRAJECTORY_DELTA &&
+        !DeltaEncoderInit(&writer.encoder, options->precision, options->keyframeInterval, WIDTH, HEIGHT)) {
+        fprintf(stderr, "Precisão relativa inválida para a trajetória: %g\n", options->precision);
+        return false;
+    }
+
+    writer.buffers = (FrameBuffer *)calloc(writer.bufferCount, sizeof(FrameBuffer));
+    writer.freeStack = (int *)malloc(sizeof(int) * writer.bufferCount);
+    writer.readyQueue = (int *)malloc(sizeof(int) * writer.bufferCount);
+    if (!writer.buffers || !writer.freeStack || !writer.readyQueue || !OpenOutput(options->path)) {
+        fprintf(stderr, "Não foi possível iniciar a gravação da trajetória em %s\n", options->path);
+        DeltaEncoderFree(&writer.encoder);
+        free(writer.buffers);
+        free(writer.freeStack);
+        free(writer.readyQueue);
+        return false;
+    }
+    for (int i = 0; i < writer.bufferCount; i++) writer.freeStack[writer.freeCount++] = i;
+
+    TrajectoryFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRAJECTORY_MAGIC, sizeof(TRAJECTORY_MAGIC));
+    header.version = TRAJECTORY_VERSION;
+    header.format = (uint32_t)writer.format;
+    if (!WriteOutput(&header, sizeof(header))) ReportWriteError();
+    if (writer.format == TRAJECTORY_DELTA) {
+        unsigned char streamHeader[16];
+        if (!WriteOutput(streamHeader, DeltaEncodeStreamHeader(&writer.encoder, streamHeader))) ReportWriteError();
+    }
+
+    pthread_mutex_init(&writer.mutex, NULL);
+    pthread_cond_init(&writer.freeCond, NULL);
+    pthread_cond_init(&writer.readyCond, NULL);
+    if (pthread_create(&writer.thread, NULL, TrajectoryWriterMain, NULL) != 0) {
+        fprintf(stderr, "Não foi possível criar a thread de escrita da trajetória\n");
+        CloseOutput();
+        DeltaEncoderFree(&writer.encoder);
+        free(writer.buffers);
+        free(writer.freeStack);
+        free(writer.readyQueue);
+        return false;
+    }
+    writer.active = true;
+    return true;
+}
+
+bool TrajectoryActive(void) {
+    return writer.active;
+}
+
+//==================================================================================
+// Chamada a cada passo. Nos passos múltiplos de 'every', copia o estado para
+// um buffer livre (esperando por um, se todos estiverem na fila de escrita)
+// e o entrega à thread de escrita.
+//==================================================================================
+void TrajectoryRecord(const Ball balls[], int numBalls, long long step) {
+    if (!writer.active || step % writer.every != 0) return;
+
+    pthread_mutex_lock(&writer.mutex);
+    if (writer.freeCount == 0) {
+        uint64_t start = TimerNowNs();
+        writer.stats.stalls++;
+        while (writer.freeCount == 0) pthread_cond_wait(&writer.freeCond, &writer.mutex);
+        writer.stats.stallMs += (TimerNowNs() - start) / 1e6;
+    }
+    int index = writer.freeStack[--writer.freeCount];
+    pthread_mutex_unlock(&writer.mutex);
+
+    // O buffer agora é só do passo; pode crescer se o número de bolas mudou.
+    FrameBuffer *buffer = &writer.buffers[index];
+    size_t needed = sizeof(TrajectoryFrameHeader) + 4 * sizeof(float) * (size_t)numBalls;
+    if (needed > buffer->capacity) {
+        unsigned char *data = (unsigned char *)realloc(buffer->data, needed);
+        if (data == NULL) {
+            ReleaseBuffer(index, 0);
+            return;
+        }
+        buffer->data = data;
+        buffer->capacity = needed;
+    }
+
+    TrajectoryFrameHeader header = { (uint64_t)step, (uint32_t)numBalls, 0 };
+    memcpy(buffer->data, &header, sizeof(header));
+    float *x = (float *)(buffer->data + sizeof(header));
+    float *y = x + numBalls;
+    float *vx = y + numBalls;
+    float *vy = vx + numBalls;
+    for (int i = 0; i < numBalls; i++) {
+        x[i] = balls[i].position.x;
+        y[i] = balls[i].position.y;
+        vx[i] = balls[i].velocity.x;
+        vy[i] = balls[i].velocity.y;
+    }
+    buffer->used = needed;
+
+    pthread_mutex_lock(&writer.mutex);
+    writer.readyQueue[(writer.readyHead + writer.readyCount) % writer.bufferCount] = index;
+    writer.readyCount++;
+    writer.stats.framesQueued++;
+    pthread_cond_signal(&writer.readyCond);
+    pthread_mutex_unlock(&writer.mutex);
+}
+
+//==================================================================================
+// Espera a thread de escrita esvaziar a fila, grava o índice (formato DELTA),
+// fecha o arquivo e libera os buffers.
+//==================================================================================
+void TrajectoryStop(void) {
+    if (!writer.active) return;
+
+    pthread_mutex_lock(&writer.mutex);
+    writer.stopping = true;
+    pthread_cond_signal(&writer.readyCond);
+    pthread_mutex_unlock(&writer.mutex);
+    pthread_join(writer.thread, NULL);
+
+    if (writer.format == TRAJECTORY_DELTA) {
+        unsigned char *index = NULL;
+        size_t capacity = 0;
+        size_t size = DeltaEncodeIndex(&writer.encoder, writer.offset, &index, &capacity);
+        if (size == 0 || !WriteOutput(index, size)) ReportWriteError();
+        free(index);
+        DeltaEncoderFree(&writer.encoder);
+    }
+
+    CloseOutput();
+    for (int i = 0; i < writer.bufferCount; i++) {
+        free(writer.buffers[i].data);
+        free(writer.buffers[i].encoded);
+    }
+    free(writer.buffers);
+    free(writer.freeStack);
+    free(writer.readyQueue);
+    pthread_mutex_destroy(&writer.mutex);
+    pthread_cond_destroy(&writer.freeCond);
+    pthread_cond_destroy(&writer.readyCond);
+    writer.active = false;
+}
+
+int DumpTrajectoryFrame(const char *path, int frame) {
+    DeltaReader reader;
+    if (!DeltaReaderOpen(&reader, path)) {
+        fprintf(stderr, "%s não é uma trajetória no formato delta\n", path);
+        return 1;
+    }
+    int capacity = DeltaReaderBallCount(&reader, frame);
+    float *x = (float *)malloc(sizeof(float) * (capacity > 0 ? capacity : 1));
+    float *y = (float *)malloc(sizeof(float) * (capacity > 0 ? capacity : 1));
+    int numBalls = 0;
+    uint64_t step = 0;
+    bool ok = x && y && DeltaReaderSeek(&reader, frame, x, y, capacity, &numBalls, &step);
+    if (ok) {
+        printf("Quadro %d de %d: passo %llu, %d bolas, precisão %g unidades\n", frame, reader.frameCount,
+               (unsigned long long)step, numBalls, reader.precision);
+        for (int i = 0; i < numBalls && i < 8; i++) printf("  bola %d: (%.3f, %.3f)\n", i, x[i], y[i]);
+    } else {
+        fprintf(stderr, "Não foi possível ler o quadro %d de %s (%d quadros)\n", frame, path, reader.frameCount);
+    }
+    free(x);
+    free(y);
+    DeltaReaderClose(&reader);
+    return ok ? 0 : 1;
+}
+
+TrajectoryStats TrajectoryGetStats(void) {
+    return writer.stats;
+}
@@ -0,0 +1,66 @@
+#ifndef TRAJECTORY_H
+#define TRAJECTORY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sim.h"
+
+// --- Gravação de trajetória ---
+// A cada K passos, posições e velocidades são copiadas para um buffer de um
+// conjunto pré-alocado e entregues a uma thread de escrita. Se o disco não
+// acompanhar, TrajectoryRecord espera um buffer livre (backpressure) em vez
+// de alocar mais memória.
+// Compilando com -DTRAJECTORY_IO_URING (e -luring), a thread de escrita usa
+// io_uring no Linux e mantém várias escritas em andamento ao mesmo tempo.
+// No formato DELTA (ver trajcodec.h) a codificação também roda nessa thread.
+#define TRAJECTORY_MAGIC "SIMTRAJ"
+#define TRAJECTORY_VERSION 1
+
+typedef enum TrajectoryFormat {
+    TRAJECTORY_RAW,    // Floats sem compressão: x, y, vx, vy de cada bola.
+    TRAJECTORY_DELTA   // Posições quantizadas, em delta e comprimidas por blocos.
+} TrajectoryFormat;
+
+typedef struct TrajectoryOptions {
+    const char *path;
+    int every;                 // Grava um quadro a cada 'every' passos.
+    int bufferCount;           // Quadros que podem esperar pela escrita.
+    TrajectoryFormat format;
+    float precision;           // DELTA: precisão das posições, como fração do maior lado do mundo.
+    int keyframeInterval;      // DELTA: um quadro-chave a cada N quadros.
+} TrajectoryOptions;
+
+// Cabeçalho do arquivo (16 bytes). No formato DELTA é seguido pelo
+// cabeçalho do fluxo e pelos quadros codificados.
+typedef struct TrajectoryFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t format;
+} TrajectoryFileHeader;
+
+// Cabeçalho de cada quadro no formato RAW, seguido de numBalls floats
+// para cada campo: x[], y[], vx[], vy[].
+typedef struct TrajectoryFrameHeader {
+    uint64_t step;
+    uint32_t numBalls;
+    uint32_t reserved;
+} TrajectoryFrameHeader;
+
+typedef struct TrajectoryStats {
+    long long framesQueued;
+    long long framesWritten;
+    long long bytesWritten;
+    long long stalls;           // Quantas vezes o passo esperou por um buffer livre.
+    double stallMs;             // Tempo total dessas esperas.
+} TrajectoryStats;
+
+bool TrajectoryStart(const TrajectoryOptions *options);
+bool TrajectoryActive(void);
+void TrajectoryRecord(const Ball balls[], int numBalls, long long step);
+void TrajectoryStop(void);
+TrajectoryStats TrajectoryGetStats(void);
+// Lê o quadro 'frame' de uma trajetória DELTA e imprime algumas posições.
+// Retorna o código de saída do programa.
+int DumpTrajectoryFrame(const char *path, int frame);
+
+#endif
@@ -0,0 +1,88 @@
+#include "view.h"
+#include <stdlib.h>
+#include <math.h>
+
+#define MIN_ZOOM 0.01f
+#define MAX_ZOOM 50.0f
+#define ZOOM_STEP 1.1f
+
+static Camera2D camera = { { 0.0f, 0.0f }, { 0.0f, 0.0f }, 0.0f, 1.0f };
+static int *candidates = NULL;
+static int candidateCapacity = 0;
+
+void ViewFit(void) {
+    float screenWidth = (float)GetScreenWidth();
+    float screenHeight = (float)GetScreenHeight();
+    float zoomX = screenWidth / WIDTH;
+    float zoomY = screenHeight / HEIGHT;
+    camera.zoom = (zoomX < zoomY) ? zoomX : zoomY;
+    camera.offset = (Vector2){ screenWidth / 2.0f, screenHeight / 2.0f };
+    camera.target = (Vector2){ WIDTH / 2.0f, HEIGHT / 2.0f };
+    camera.rotation = 0.0f;
+}
+
+//==================================================================================
+// Zoom em torno do cursor: o ponto do mundo sob o mouse vira o alvo da câmera
+// e o mouse, o seu deslocamento, então ele fica parado na tela.
+//==================================================================================
+void ViewHandleInput(void) {
+    float wheel = GetMouseWheelMove();
+    if (wheel != 0.0f) {
+        Vector2 mouse = GetMousePosition();
+        camera.target = GetScreenToWorld2D(mouse, camera);
+        camera.offset = mouse;
+        camera.zoom *= powf(ZOOM_STEP, wheel);
+        if (camera.zoom < MIN_ZOOM) camera.zoom = MIN_ZOOM;
+        if (camera.zoom > MAX_ZOOM) camera.zoom = MAX_ZOOM;
+    }
+    if (IsMouseButtonDown(MOUSE_BUTTON_RIGHT) || IsMouseButtonDown(MOUSE_BUTTON_MIDDLE)) {
+        Vector2 delta = GetMouseDelta();
+        camera.target.x -= delta.x / camera.zoom;
+        camera.target.y -= delta.y / camera.zoom;
+    }
+    if (IsKeyPressed(KEY_C)) ViewFit();
+}
+
+Camera2D ViewCamera(void) {
+    return camera;
+}
+
+//==================================================================================
+// O retângulo visível é expandido pelo maior raio mais uma célula: uma bola
+// pode estar na célula ao lado e ainda aparecer, e as posições mudaram um
+// pouco na narrowphase depois de a grade ser construída.
+//==================================================================================
+int CollectVisibleBalls(const Ball balls[], const SpatialGrid *grid, const Vector2 *previous, float alpha,
+                        Ball **visible, int *capacity) {
+    Vector2 topLeft = GetScreenToWorld2D((Vector2){ 0.0f, 0.0f }, camera);
+    Vector2 bottomRight = GetScreenToWorld2D((Vector2){ (float)GetScreenWidth(), (float)GetScreenHeight() }, camera);
+    float margin = MAX_BALL_RADIUS + grid->cellSize;
+    int count = QuerySpatialGrid(grid, topLeft.x - margin, topLeft.y - margin, bottomRight.x + margin,
+                                 bottomRight.y + margin, &candidates, &candidateCapacity);
+    if (count < 0) return -1;
+
+    if (count > *capacity) {
+        Ball *grown = (Ball *)realloc(*visible, sizeof(Ball) * count);
+        if (grown == NULL) return -1;
+        *visible = grown;
+        *capacity = count;
+    }
+
+    // Teste exato do círculo contra o retângulo da tela, na posição desenhada.
+    int kept = 0;
+    for (int k = 0; k < count; k++) {
+        int i = candidates[k];
+        Vector2 position = balls[i].position;
+        if (previous != NULL) {
+            position.x = previous[i].x + (position.x - previous[i].x) * alpha;
+            position.y = previous[i].y + (position.y - previous[i].y) * alpha;
+        }
+        float r = (float)balls[i].radius;
+        if (position.x + r < topLeft.x || position.x - r > bottomRight.x ||
+            position.y + r < topLeft.y || position.y - r > bottomRight.y) continue;
+        (*visible)[kept] = balls[i];
+        (*visible)[kept].position = position;
+        kept++;
+    }
+    return kept;
+}
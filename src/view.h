@@ -0,0 +1,28 @@
+#ifndef VIEW_H
+#define VIEW_H
+
+#include "sim.h"
+#include "grid.h"
+
+// --- Câmera ---
+// Camera2D sobre o mundo: a roda do mouse aproxima em torno do cursor, o
+// botão direito (ou do meio) arrasta e [C] volta a enquadrar o mundo todo.
+// A janela tem no máximo MAX_WINDOW_WIDTH x MAX_WINDOW_HEIGHT; mundos maiores
+// só cabem inteiros com zoom menor que 1.
+#define MAX_WINDOW_WIDTH 1280
+#define MAX_WINDOW_HEIGHT 800
+
+// Enquadra o mundo inteiro, centralizado na janela.
+void ViewFit(void);
+void ViewHandleInput(void);
+Camera2D ViewCamera(void);
+
+// Copia para 'visible' (realocado se preciso) as bolas que aparecem na tela,
+// consultando a grade só nas células visíveis. A grade precisa refletir as
+// posições atuais a menos de uma célula. Com 'previous', cada bola copiada
+// fica em previous + (atual - previous) * alpha, e é essa posição que decide
+// se ela aparece. Retorna quantas, ou -1 sem memória.
+int CollectVisibleBalls(const Ball balls[], const SpatialGrid *grid, const Vector2 *previous, float alpha,
+                        Ball **visible, int *capacity);
+
+#endif